@@ -1,194 +1,131 @@
 #include <stdint.h>
 
 
+/* instruction decoded once by the translator, used by all later passes */
 typedef struct{
         //opcode of instruction
         uint8_t opcode;
         //address of Instruction
         uint16_t address;
-        //parameter of instruction or label
+        //operand bytes as stored in memory (little endian)
+        uint16_t operand;
+        //parameter of instruction or label (resolved target of branches and jumps)
         uint16_t parameter;
+        //length of instruction
+        uint8_t bytes;
+        //clock cycles needed
+        uint8_t cycles;
+        //flags used and defined by instruction
+        uint8_t uses;
+        uint8_t defs;
 } BinaryInstruction;
 
 struct Instructions{
-        //opcode
-        void (*opcode)(void);
+        //mnemonic (index into opcodes of representation)
+        uint8_t mnemonic;
         //addressing mode
         uint8_t addressingMode;
         //clock cycles needed
         int cycles;
 };
 
-void
-call_corresponding_addressingMode(uint8_t opcode);
-
-void print_prolog(void);
-void print_global_vars_and_functions(void);
-void print_main(void);
-void print_epilog(void);
-/*void
-convert_number_to_bcd(void);
-void
-convert_bcd_to_number(void);
-*/
-/* Instructions */
-
-void ADC(void);
-
-void AND(void);
-
-void ASL(void);
-
-void BCC(void);
-void BCS(void);
-
-void BEQ(void);
-void BIT(void);
-
-void BMI(void);
-void BNE(void);
-
-void BPL(void);
-
-void BRK(void);
-
-void BVC(void);
-
-void BVS(void);
-void CLC(void);
-void CLD(void);
-
-void CLI(void);
-
-void CLV(void);
-
-void CMP(void);
-
-void CPX(void);
-
-void CPY(void);
-void DEC(void);
-void DEX(void);
-
-void DEY(void);
-
-void EOR(void);
-
-void INC(void);
-
-void INX(void);
-
-void INY(void);
-
-void JMP(void);
-
-void JSR(void);
-
-void LDA(void);
-
-void LDX(void);
-
-void LDY(void);
-void LSR(void);
-
-void NOP(void);
-void ORA(void);
-
-void PHA(void);
-void PHP(void);
-
-void PLA(void);
-
-void PLP(void);
-
-void ROL(void);
-
-void ROR(void);
-
-void RTI(void);
-void RTS(void);
-
-void SBC(void);
-
-void SEC(void);
-
-void SED(void);
-
-void SEI(void);
-
-
-void TAX(void);
-
-void TAY(void);
-
-void TSX(void);
-
-void TXA(void);
-
-void TXS(void);
-
-void TYA(void);
-/* "Illegal" Opcodes */
-
-void ALR(void);
-
-void ANC(void);
-
-void ANC2(void);
-
-void ARR(void);
-void DCP(void);
-
-void ISC(void);
-
-void LAS(void);
-
-void LAX(void);
-
-void RLA(void);
-
-void RRA(void);
-
-void SAX(void);
-
-void SBX(void);
-
-void SLO(void);
-
-void SRE(void);
-
-void USBC(void);
-
-void JAM(void);
-
-/* Instructions */
-void STA(void);
-
-void STX(void);
-
-void STY(void);
-
-/* Addressing Modes */
-
-void absolute(void);
-
-void absolute_x (void);
-
-void absolute_y(void);
-
-void immediate(void);
-
-void implied(void);
-
-void indirect(void);
-
-void indirect_y(void);
-
-void indexed_x(void);
+/* attributes of an address in the 6502 address space (address_attributes in translator.c) */
+enum{
+	ATTR_LEADER = (1 << 0),		//address is leader of a basic block
+	ATTR_BASICBLOCK = (1 << 1),	//address is start of a basic block
+	ATTR_IO = (1 << 2),		//instruction at address is an I/O operation
+	ATTR_JSR_TARGET = (1 << 3),	//address is target of a JSR instruction
+	ATTR_ROM_DATA = (1 << 4),	//ROM byte readable by indexed addressing
+	ATTR_RRIOT_DATA = (1 << 5),	//RRIOT ROM byte readable by indexed addressing
+	ATTR_CODE = (1 << 6),		//byte is part of a reachable instruction
+	ATTR_INSTRUCTION = (1 << 7)	//reachable instruction starts at address
+};
 
-void relative(void);
+/* kinds of regions in the memory map of the 6502 system (memory_map in translator.c) */
+enum{
+	REGION_NONE = 0,	//address not mapped
+	REGION_RAM,		//RAM (zero page, stack)
+	REGION_IO,		//I/O registers of RRIOT
+	REGION_RRIOT_RAM,	//RAM of RRIOT
+	REGION_RRIOT_ROM,	//ROM of RRIOT
+	REGION_ROM,		//ROM containing program
+	REGION_DATA		//ROM containing no instructions (tables, vectors)
+};
 
-void zeropage(void);
-void zeropage_x(void);
+typedef struct{
+	//first address of region
+	uint16_t start;
+	//last address of region
+	uint16_t end;
+	//kind of region
+	uint8_t kind;
+} MemoryRegion;
+
+uint8_t
+get_memory_region(uint16_t address);
+
+/* index of address in the array of the generated code representing its kind of region
+ * and number of addresses of a kind (see index_memory_regions) */
+uint16_t
+get_region_index(uint16_t address);
+
+int
+get_region_size(uint8_t kind);
+
+/* mnemonics of 6502, index into opcodes of a representation */
+enum{
+	/* Instructions */
+	OP_ADC, OP_AND, OP_ASL, OP_BCC, OP_BCS, OP_BEQ, OP_BIT, OP_BMI,
+	OP_BNE, OP_BPL, OP_BRK, OP_BVC, OP_BVS, OP_CLC, OP_CLD, OP_CLI,
+	OP_CLV, OP_CMP, OP_CPX, OP_CPY, OP_DEC, OP_DEX, OP_DEY, OP_EOR,
+	OP_INC, OP_INX, OP_INY, OP_JMP, OP_JSR, OP_LDA, OP_LDX, OP_LDY,
+	OP_LSR, OP_NOP, OP_ORA, OP_PHA, OP_PHP, OP_PLA, OP_PLP, OP_ROL,
+	OP_ROR, OP_RTI, OP_RTS, OP_SBC, OP_SEC, OP_SED, OP_SEI, OP_STA,
+	OP_STX, OP_STY, OP_TAX, OP_TAY, OP_TSX, OP_TXA, OP_TXS, OP_TYA,
+	/* "Illegal" Opcodes */
+	OP_ALR, OP_ANC, OP_ANC2, OP_ARR, OP_DCP, OP_ISC, OP_LAS, OP_LAX,
+	OP_RLA, OP_RRA, OP_SAX, OP_SBX, OP_SLO, OP_SRE, OP_USBC, OP_JAM,
+	NUMBER_OF_MNEMONICS
+};
 
-void zeropage_y(void);
+/* representation of generated code, selected at runtime by the translator.
+ * Every representation module exports one Backend, all other symbols are local to the module */
+typedef struct{
+	//name of representation (-b option)
+	const char *name;
+	//opcodes: analysis with toSet == DEFS, code generation with toSet == IR
+	void (**opcodes)(void);
+	//addressing mode of opcode at pc: sets parameter and bytes
+	void (*addressing_mode)(uint8_t opcode);
+	//surrounding code
+	void (*prolog)(void);
+	void (*global_vars_and_functions)(void);
+	void (*helper_functions)(void);
+	void (*main)(void);
+	void (*epilog)(void);
+	//subroutine translated to function (see get_function), NULL if all code is printed in main
+	void (*function_prolog)(uint16_t entry);
+	void (*function_epilog)(void);
+	//addition of cycles outside of conditional branches, nothing is printed for 0 cycles
+	void (*add_cycles)(int value);
+	//collapsed delay loop: adds cycles and sets X and Y (-1 == unchanged) and N and Z from result (-1 == unchanged)
+	void (*delay_loop)(uint32_t cycles, int x, int y, int result);
+} Backend;
+
+/* entry of subroutine translated to function containing instruction at address, -1 for code in main */
+int
+get_function(uint16_t address);
+
+/* function is copied to every JSR (leaf subroutine), no code is printed for it */
+uint8_t
+is_inlined(uint16_t entry);
+
+/* zero page bytes held in registers by the representations (at most MAX_PROMOTED_ZERO_PAGE),
+ * indexed and indirect accesses to them are redirected at runtime by read8 and write8 */
+#define MAX_PROMOTED_ZERO_PAGE 4
+
+int
+get_promoted_zero_page(uint8_t promoted[]);
+
+extern Backend c_backend;
+extern Backend avr_backend;
@@ -2,15 +2,15 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "6502_instructions.h"
+#include "6502_representation.h"
 
 #define MAX_HELPER_FUNCTIONS 9
-#define RRIOT_RAM_START 0x8b80
-#define RRIOT_ROM_START 0x8c00
-#define RRIOT_IO_START 0x8b00
+//promoted zero page bytes are kept in r6 ... r9
+#define PROMOTED_REGISTER 6
 
 extern uint16_t pc;
 extern uint8_t m[65536];
-BinaryInstruction program_blocks[0xffff][255];
+extern uint8_t address_attributes[65536];
 
 extern struct Instructions code[256];
 enum { CF=0, ZF, IF, DF, BF, XX, VF, NF };
@@ -18,33 +18,30 @@ enum { RA=0, RY, RX, RS};
 
 /* Communication with Translator*/
 enum{DEFS, IR, BYTES, DYNAMIC};
+extern uint16_t parameter; //set by addressing mode
+extern uint8_t bytes;
 
 extern int toSet;
 extern uint8_t defs;
 extern uint8_t uses;
 extern uint8_t usedRegisters;
 extern uint8_t optimization;
+extern uint8_t output_queue; //length of output queue (run-ahead), 0 == write_io waits for output
 extern uint16_t cycles;
+extern uint16_t cycles_taken; //cycles of taken path of conditional branch
 
 /* communication for printing */
-uint16_t rriot_rom[1024];
-uint16_t rriot_addr;
-uint16_t rom_addresses[4096];
-uint16_t rom_addr;
 
-uint16_t jsr_counter;
-uint16_t jsr[2048];
+static uint16_t jsr_counter;
+static uint16_t jsr[2048];
 
-extern void (*used_helper_functions[9])(void);
-int helperFunctions = 0;
+static void (*used_helper_functions[MAX_HELPER_FUNCTIONS])(void);
+static int helperFunctions = 0;
 
 /* Helper Functions */
-uint16_t parameter; //set by addressing mode
-uint8_t bytes;
-
 extern uint8_t bcd;
 
-void
+static void
 add_used_helper_function(void (*helper_function)(void)){
 	if(helperFunctions == MAX_HELPER_FUNCTIONS){
 		return;
@@ -59,7 +56,7 @@ add_used_helper_function(void (*helper_function)(void)){
 	}
 }
 
-int
+static int
 is_absolute_address(uint8_t opcode){
 	uint16_t addressingMode = code[opcode].addressingMode;
        	if((addressingMode == 0x9) || (addressingMode == 0x8) || (addressingMode == 0xa)){
@@ -69,13 +66,14 @@ is_absolute_address(uint8_t opcode){
 	}
 }
 
-int
+static int
 is_in_ROM(uint16_t parameter){
-	//in RRIOT_ROM or ROM
-	return ((parameter >= RRIOT_ROM_START) && (parameter <= 0x8FFF)) || ((parameter >= 0xF000) && (parameter <= 0xFFFF));
+	//in RRIOT_ROM or ROM (including tables and vectors) of memory map
+	uint8_t kind = get_memory_region(parameter);
+	return (kind == REGION_RRIOT_ROM) || (kind == REGION_ROM) || (kind == REGION_DATA);
 }
 
-void
+static void
 check_for_indexed_addressing(uint8_t opcode){
 	if((code[opcode].addressingMode == 0x15) || (code[opcode].addressingMode == 0x1d) || (code[opcode].addressingMode == 0x1)){
 		//X-Register needed
@@ -86,7 +84,7 @@ check_for_indexed_addressing(uint8_t opcode){
 	}
 }
 
-void
+static void
 call_corresponding_addressingMode(uint8_t opcode){
 	//jumps
 	if((opcode == 0x20) || (opcode == 0x4C)){
@@ -137,70 +135,209 @@ call_corresponding_addressingMode(uint8_t opcode){
         };
 }
 
-int 
-is_IO_operation(uint16_t address){
-	return ((address >= RRIOT_IO_START) && (address < RRIOT_RAM_START));
+/* memory operand of instruction at pc with address known at translation time,
+ * accessed directly instead of by the generic read8 and write8 */
+enum{ACCESS_MEMORY, ACCESS_RAM, ACCESS_RRIOT_RAM, ACCESS_IO, ACCESS_PROMOTED};
+
+static int
+is_promoted(uint16_t address){
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+	for(int i = 0; i < count; i++){
+		if(promoted[i] == address){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int
+classify_access(void){
+	uint8_t addressingMode = code[m[pc]].addressingMode;
+	if((addressingMode != 0x5) && (addressingMode != 0xd)){
+		//indexed or indirect
+		return ACCESS_MEMORY;
+	}
+	if(is_promoted(parameter)){
+		return ACCESS_PROMOTED;
+	}
+	switch(get_memory_region(parameter)){
+		case REGION_RAM:
+			return ACCESS_RAM;
+		case REGION_RRIOT_RAM:
+			return ACCESS_RRIOT_RAM;
+		case REGION_IO:
+			return ACCESS_IO;
+	}
+	return ACCESS_MEMORY;
+}
+
+static void
+print_read8(void){
+	switch(classify_access()){
+		case ACCESS_PROMOTED:
+			printf("zp_%x", parameter);
+			break;
+		case ACCESS_RAM:
+			printf("m[%d]", get_region_index(parameter));
+			break;
+		case ACCESS_RRIOT_RAM:
+			printf("rriot_ram[%d]", get_region_index(parameter));
+			break;
+		default:
+			printf("read8(");
+			call_corresponding_addressingMode(m[pc]);
+			printf(")");
+	}
+}
+
+/* store to memory operand, value is printed between print_store_begin and print_store_end */
+static void
+print_store_begin(void){
+	switch(classify_access()){
+		case ACCESS_PROMOTED:
+			printf("\t zp_%x = ", parameter);
+			break;
+		case ACCESS_RAM:
+			printf("\t m[%d] = ", get_region_index(parameter));
+			break;
+		case ACCESS_RRIOT_RAM:
+			printf("\t rriot_ram[%d] = ", get_region_index(parameter));
+			break;
+		case ACCESS_IO:
+			printf("\t write_io(");
+			break;
+		default:
+			printf("\t write8(");
+			if(toSet == DYNAMIC){
+				call_corresponding_addressingMode(m[pc]);
+			}else{
+				printf("%d", parameter);
+			}
+			printf(", ");
+	}
+}
+
+static void
+print_store_end(void){
+	int access = classify_access();
+	if((access == ACCESS_IO) || (access == ACCESS_MEMORY)){
+		printf(");\n");
+	}else{
+		printf(";\n");
+	}
+}
+
+/* cycles added on a path of a conditional branch, flags saved in temp are restored after the addition */
+static void
+print_branch_cycles(const char *indent, int value){
+	if(value != 0){
+		printf("%s cycles += %d;\n", indent, value);
+		printf("%s SREG = temp;\n", indent);
+	}
+}
+
+/* cycles added outside of conditional branches, the translator carries cycles into successors (-O 1),
+ * so they may be 0. The 32 bit addition changes C and V kept in SREG */
+static void
+print_add_cycles(int value){
+	if(value != 0){
+		printf("\t temp = SREG;\n");
+		printf("\t cycles += %d;\n", value);
+		printf("\t SREG = temp;\n");
+	}
 }
 
 /* print surounding code */
-uint16_t
-get_min_rom(void){
-	uint16_t min = 0xffff;
-	for(int i = 0; i < rom_addr; i++){
-		if(rom_addresses[i] < min){
-			min = rom_addresses[i];
+/* first and last address of page read by indexed addressing (ATTR_ROM_DATA or ATTR_RRIOT_DATA), 0 if there is none */
+static int
+get_rom_range(int page, uint8_t attribute, uint16_t *first, uint16_t *last){
+	int found = 0;
+	for(int i = page << 8; i < ((page + 1) << 8); i++){
+		if(address_attributes[i] & attribute){
+			if(!found){
+				*first = i;
+				found = 1;
+			}
+			*last = i;
 		}
 	}
-	return min;
+	return found;
 }
 
-uint16_t
-get_max_rom(void){
-        uint16_t max = 0x0;
-        for(int i = 0; i < rom_addr; i++){
-                if(rom_addresses[i] > max){
-                        max = rom_addresses[i];
-                }
-        }
-        return max;
+/* first and last address of a kind of region in the memory map */
+static int
+get_region_bounds(uint8_t kind, uint16_t *first, uint16_t *last){
+	int found = 0;
+	for(int i = 0; i <= 0xffff; i++){
+		if(get_memory_region(i) == kind){
+			if(!found){
+				*first = i;
+				found = 1;
+			}
+			*last = i;
+		}
+	}
+	return found;
 }
 
-uint16_t
-get_min_rriot(void){
-        uint16_t min = 0xffff;
-        for(int i = 0; i < rriot_addr; i++){
-                if(rriot_rom[i] < min){
-                        min = rriot_rom[i];
-                }
-        }
-        return min;
+/* RAM (m) and RRIOT RAM (rriot_ram) of generated code hold the addresses of their regions in address order */
+static int
+get_array_size(uint8_t kind){
+	int size = get_region_size(kind);
+	return (size > 0) ? size : 1;
 }
 
-uint16_t
-get_max_rriot(void){
-        uint16_t max = 0x0;
-        for(int i = 0; i < rriot_addr; i++){
-                if(rriot_rom[i] > max){
-                        max = rriot_rom[i];
-                }
-        }
-        return max;
+static int
+has_rom_table(uint8_t attribute){
+	uint16_t first;
+	uint16_t last;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			return 1;
+		}
+	}
+	return 0;
 }
 
+/* ROM read by indexed addressing as table in flash, ranges of all pages are packed in ascending order (see print_page_table) */
+static void
+print_rom_table(const char *name, uint8_t attribute){
+	uint16_t first;
+	uint16_t last;
+	int size = 0;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			size += last - first + 1;
+		}
+	}
+	printf("const uint8_t %s[%d] PROGMEM = {", name, size);
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			for(int i = first; i <= last; i++){
+				size--;
+				printf((size > 0) ? "%d, " : "%d};\n", m[i]);
+			}
+		}
+	}
+}
 
-void
+
+static void
 print_set_up_timer(void){
-	printf("void\nset_up_timer(uint16_t start){\n");
+	printf("void\nset_up_timer(uint32_t start){\n");
         printf("\t TCCR1A = 0;\n");
-        printf("\t TCCR1B |= (1 << CS10);\n");
-	printf("\t TIMSK1 |= (1 << TOIE1);\n");
+	//prescaler 8: Timer1 counts TICKS_PER_CYCLE ticks for every 6502 cycle
+        printf("\t TCCR1B = (1 << CS11);\n");
+	printf("\t TIMSK1 = (1 << TOIE1);\n");
         printf("\t TCNT1 = start;\n");
-	printf("\t overflow = 0;\n");
-	printf("\t io = 0;\n");
-	printf("}\n\n");
+	printf("\t epoch = 0;\n");
+	printf("\t deadline = start;\n");
+	printf("\t set_sleep_mode(SLEEP_MODE_IDLE);\n");
+        printf("}\n\n");
 }
 
-void
+static void
 print_calculate_time_cycles(void){
 	printf("uint16_t\ncalculate_time(uint16_t counter){\n");
 	printf("\t return (uint16_t) counter/16;\n");
@@ -208,29 +345,37 @@ print_calculate_time_cycles(void){
 }
 
 
-void
+static void
 print_prolog(void){
         printf("#include <stdint.h>\n");
         printf("#include <avr/io.h>\n");
         printf("#include <avr/interrupt.h>\n");
+        printf("#include <avr/pgmspace.h>\n");
+        printf("#include <avr/sleep.h>\n");
         printf("#include \"serialCom.h\"\n\n");
 
-        printf("#define OUTPUT_MIN 0x8b00\n");
-        printf("#define OUTPUT_MAX 0x8b7f\n\n");
-
-	printf("#define RAM_MIN 0x0000\n");
-        printf("#define RAM_MAX 0x01ff\n\n");
-
-	if(rom_addr > 0){
-		printf("#define ROM_MIN %d\n", get_min_rom());
+        //16 MHz AVR, 1 MHz 6502, Timer1 prescaler 8
+	printf("#define TICKS_PER_CYCLE 2\n");
+	if(output_queue > 0){
+		printf("#define OUTPUT_QUEUE_SIZE %d\n", output_queue);
+		printf("#define OUTPUT_QUEUE_MASK (OUTPUT_QUEUE_SIZE - 1)\n");
+		//release_output tries again after 128 us if the transmit queue of serialCom.c is full
+		printf("#define OUTPUT_RETRY_TICKS 256\n");
 	}
-	if(rriot_addr > 0){
-		printf("#define RRIOT_MIN %d\n", get_min_rriot());
+	uint16_t first;
+	uint16_t last;
+	if(get_region_bounds(REGION_IO, &first, &last)){
+		printf("#define OUTPUT_MIN 0x%04x\n", first);
+		printf("#define OUTPUT_MAX 0x%04x\n\n", last);
 	}
-	printf("\n");
+	if(get_region_bounds(REGION_RAM, &first, &last)){
+		printf("#define RAM_MIN 0x%04x\n", first);
+		printf("#define RAM_MAX 0x%04x\n\n", last);
+	}
+
 }
 
-void
+static void
 print_global_vars_and_functions(void){
 	if(optimization){
 		if(usedRegisters & (1 << RA)){
@@ -253,38 +398,37 @@ print_global_vars_and_functions(void){
 	}
 	printf("volatile register uint8_t temp asm (\"r14\");\n\n");
 
-        printf("volatile uint8_t wait;\n");
-        printf("volatile uint8_t ioValue;\n\n");
-	printf("volatile uint8_t io;\n");
-        printf("volatile uint16_t overflow;\n");
+	//Timer1 overflows and time of last output (see write_io)
+	printf("volatile uint16_t epoch;\n");
+	printf("uint32_t deadline;\n");
 
         printf("uint32_t cycles;\n");
-        printf("uint8_t m[512];\n");
-	printf("uint8_t rriot_ram[64];\n\n");
-
-	if(rom_addr > 0){
-		printf("uint16_t rom[%d] = {", rom_addr);
-		uint16_t end = get_max_rom();
-		for(int i = get_min_rom(); i < end; i++){
-			printf("%d, ", m[i]);
+        printf("uint8_t m[%d];\n", get_array_size(REGION_RAM));
+	printf("uint8_t rriot_ram[%d];\n\n", get_array_size(REGION_RRIOT_RAM));
+	if(optimization){
+		uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+		int count = get_promoted_zero_page(promoted);
+		for(int i = 0; i < count; i++){
+			printf("volatile register uint8_t zp_%x asm (\"r%d\");\n", promoted[i], PROMOTED_REGISTER + i);
+		}
+		if(count > 0){
+			printf("\n");
 		}
-		printf("%d};\n", m[end]);
 	}
-	if(rriot_addr > 0){
-                printf("uint16_t rriot_rom[%d] = {", rriot_addr);
-                uint16_t end = get_max_rriot();
-                for(int i = get_min_rriot(); i < end; i++){
-                        printf("%d, ", m[i]);
-                }
-                printf("%d};\n", m[end]);
-        }
+
+	if(has_rom_table(ATTR_ROM_DATA)){
+		print_rom_table("rom", ATTR_ROM_DATA);
+	}
+	if(has_rom_table(ATTR_RRIOT_DATA)){
+		print_rom_table("rriot_rom", ATTR_RRIOT_DATA);
+	}
 	printf("\n");
 
         print_set_up_timer();
         print_calculate_time_cycles();
 }
 
-void
+static void
 print_main(void){
 	printf("int main(void){\n");
         printf("\t set_up_timer(0);\n");
@@ -304,6 +448,11 @@ print_main(void){
 		if(usedRegisters & (1 << RS)){
         		printf("\t rs = 0xfd;\n");
 		}
+		uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+		int count = get_promoted_zero_page(promoted);
+		for(int i = 0; i < count; i++){
+			printf("\t zp_%x = 0;\n", promoted[i]);
+		}
 	}else{
 		printf("\t ra = 0;\n");
 		printf("\t rx = 0;\n");
@@ -312,26 +461,41 @@ print_main(void){
 	}
 }
 
-void
+static void
 print_epilog(void){
 	printf("}\n\n");
 
-        printf("ISR(TIMER1_OVF_vect){\n");
-        printf("\t if(io && (overflow == 0)){\n");
-        printf("\t\t putChar(ioValue);\n");
-        printf("\t\t putChar('\\n');\n");
-        printf("\t\t wait = 0;\n");
-        printf("\t }else if((io && (overflow != 0))){\n");
-        printf("\t\t overflow--;\n");
-        printf("\t }else{\n");
-        printf("\t\t overflow++;\n");
-        printf("\t }\n");
-	printf("}\n");
+	printf("ISR(TIMER1_OVF_vect){\n");
+	printf("\t epoch++;\n");
+	printf("}\n\n");
+	if(output_queue == 0){
+		//only wakes write_io
+		printf("EMPTY_INTERRUPT(TIMER1_COMPA_vect);\n");
+	}
+}
+
+/* collapsed delay loop (see collapse_delay_loops): only its cycles and the state it leaves are printed,
+ * C and V are kept in SREG */
+static void
+print_delay_loop(uint32_t cycles, int x, int y, int result){
+	printf("\t temp = SREG;\n");
+	printf("\t cycles += %lu;\n", (unsigned long) cycles);
+	printf("\t SREG = temp;\n");
+	if(x != -1){
+		printf("\t __asm__ volatile(\"mov %%0, %%1\" : \"=r\"(rx) : \"r\"((uint8_t)%d));\n", x);
+	}
+	if(y != -1){
+		printf("\t __asm__ volatile(\"mov %%0, %%1\" : \"=r\"(ry) : \"r\"((uint8_t)%d));\n", y);
+	}
+	if(result != -1){
+		printf("\t __asm__ volatile(\"%s\");\n", (result == 0) ? "sez" : "clz");
+		printf("\t __asm__ volatile(\"%s\");\n", (result & 0x80) ? "sen" : "cln");
+	}
 }
 
 /* Code for printing flags */
 
-void
+static void
 invert_CF_flag(void){
 	if(optimization && ((defs & (1 << CF)) == 0)){
 		return;
@@ -343,7 +507,7 @@ invert_CF_flag(void){
         printf("\t }\n");
 }
 
-void
+static void
 set_missing_flags(uint8_t reg){
 	if(optimization && (!((defs & (1 << NF)) || (defs & (1 << ZF))))){
 		return;
@@ -382,7 +546,7 @@ set_missing_flags(uint8_t reg){
 	}
 }
 
-void
+static void
 set_NF_ZF_for_memory(void){
 	if(optimization){
 		if(defs & (1 << NF)){
@@ -404,99 +568,385 @@ set_NF_ZF_for_memory(void){
 	}
 }
 
-void
+static void
 save_VF(void){
 	printf("\t temp = SREG;\n");
         printf("\t __asm__ volatile(\"bst %%0, %%1\" : \"=r\"(temp) : \"I\"(3));\n");
 }
 
-void
+static void
 restore_VF(void){
 	printf("\t temp = 0;\n");
         printf("\t __asm__ volatile(\"bld %%0, %%1\" : \"=r\"(temp) : \"I\"(0));\n");
         printf("\t if(temp){\n \t\t __asm__ volatile(\"sev\");\n\t }else{\n \t\t __asm__ volatile(\"clv\");\n\t }\n");
 }
 
-void
-print_ram_or_rriot(void){
-	if((parameter >= RRIOT_RAM_START) && (parameter < RRIOT_ROM_START)){
-		printf("\t rriot_ram[");
-		if(toSet == DYNAMIC){
+/* memory operand modified in place (ASL, LSR, ROL, ROR, INC, DEC), known addresses are accessed like by print_read8 */
+static void
+print_memory_operand(void){
+	switch(classify_access()){
+		case ACCESS_PROMOTED:
+			printf("zp_%x", parameter);
+			break;
+		case ACCESS_RAM:
+			printf("m[%d]", get_region_index(parameter));
+			break;
+		case ACCESS_RRIOT_RAM:
+			printf("rriot_ram[%d]", get_region_index(parameter));
+			break;
+		default:
+			printf("m[");
 			call_corresponding_addressingMode(m[pc]);
+			printf("]");
+	}
+}
+
+static void
+print_ram_or_rriot(void){
+	printf("\t ");
+	print_memory_operand();
+	printf(" = ");
+	print_memory_operand();
+}
+/* possible Helper Functions for Programm Execution */
+
+/* page table of generated code: kind of every 6502 page and index of its first byte in the array
+ * representing the page, read8 and write8 need one lookup for every address. A page holding more
+ * than one kind of region of the memory map is PAGE_MIXED, its regions are tested by address */
+enum{PAGE_NONE, PAGE_RAM, PAGE_RRIOT, PAGE_IO, PAGE_MIXED, PAGE_ROM, PAGE_RRIOT_ROM};
+
+static int
+get_page_kind(int page){
+	int count[REGION_DATA + 1] = {0};
+	for(int i = page << 8; i < ((page + 1) << 8); i++){
+		count[get_memory_region(i)]++;
+	}
+	if(count[REGION_RAM] == 256){
+		return PAGE_RAM;
+	}else if(count[REGION_RRIOT_RAM] == 256){
+		return PAGE_RRIOT;
+	}else if(count[REGION_IO] == 256){
+		return PAGE_IO;
+	}else if(count[REGION_RAM] + count[REGION_RRIOT_RAM] + count[REGION_IO] > 0){
+		return PAGE_MIXED;
+	}
+	return PAGE_NONE;
+}
+
+static void
+print_page_table(void){
+	uint8_t kind[256] = {PAGE_NONE};
+	uint16_t base[256] = {0};
+
+	for(int page = 0; page < 256; page++){
+		kind[page] = get_page_kind(page);
+		if((kind[page] == PAGE_RAM) || (kind[page] == PAGE_RRIOT)){
+			base[page] = get_region_index(page << 8);
+		}
+	}
+	//index into ROM tables is offset of range of page minus its first address in page (modulo 2^16)
+	uint16_t first;
+	uint16_t last;
+	uint16_t rom_offset = 0;
+	uint16_t rriot_offset = 0;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, ATTR_ROM_DATA, &first, &last)){
+			kind[page] = (kind[page] == PAGE_MIXED) ? PAGE_MIXED : PAGE_ROM;
+			base[page] = rom_offset - (first & 0xff);
+			rom_offset += last - first + 1;
+		}else if(get_rom_range(page, ATTR_RRIOT_DATA, &first, &last)){
+			kind[page] = (kind[page] == PAGE_MIXED) ? PAGE_MIXED : PAGE_RRIOT_ROM;
+			base[page] = rriot_offset - (first & 0xff);
+			rriot_offset += last - first + 1;
+		}
+	}
+
+	printf("#define PAGE_NONE %d\n", PAGE_NONE);
+	printf("#define PAGE_RAM %d\n", PAGE_RAM);
+	printf("#define PAGE_RRIOT %d\n", PAGE_RRIOT);
+	printf("#define PAGE_IO %d\n", PAGE_IO);
+	printf("#define PAGE_MIXED %d\n", PAGE_MIXED);
+	printf("#define PAGE_ROM %d\n", PAGE_ROM);
+	printf("#define PAGE_RRIOT_ROM %d\n\n", PAGE_RRIOT_ROM);
+	printf("const uint8_t page_kind[256] PROGMEM = {");
+	for(int page = 0; page < 256; page++){
+		printf((page < 255) ? "%d, " : "%d};\n", kind[page]);
+	}
+	printf("const uint16_t page_base[256] PROGMEM = {");
+	for(int page = 0; page < 256; page++){
+		printf((page < 255) ? "%d, " : "%d};\n\n", base[page]);
+	}
+}
+
+/* access of read8 (write == 0) or write8 to RAM, RRIOT RAM or I/O of region start ... end of a PAGE_MIXED page */
+static void
+print_mixed_region(const char *address, int write, uint8_t region, uint16_t start, uint16_t end){
+	if((region != REGION_RAM) && (region != REGION_RRIOT_RAM) && (region != REGION_IO)){
+		return;
+	}
+	printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, start, address, end);
+	//index in array is address minus number of addresses of other kinds below it
+	const char *array = (region == REGION_RAM) ? "m" : "rriot_ram";
+	int offset = start - get_region_index(start);
+	if(write){
+		if(region == REGION_IO){
+			printf("\t\t\t\t write_io(value);\n");
 		}else{
-			printf("%d", parameter);
+			printf("\t\t\t\t %s[%s - 0x%04x] = value;\n", array, address, offset);
 		}
-		printf("] = rriot_ram[");
-		if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                }else{
-                        printf("%d", parameter);
-                }
+		printf("\t\t\t\t return;\n");
+	}else if(region == REGION_IO){
+		if(output_queue > 0){
+			printf("\t\t\t\t sync_io();\n");
+		}
+		printf("\t\t\t\t return 0;\n");
 	}else{
-		printf("\t m[");
-                if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                }else{
-                        printf("%d", parameter);
-                }
-                printf("] = m[");
-                if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                }else{
-                        printf("%d", parameter);
-                }
+		printf("\t\t\t\t return %s[%s - 0x%04x];\n", array, address, offset);
 	}
-	printf("]");
+	printf("\t\t\t }\n");
+}
+
+static void
+print_mixed_pages(const char *address, int write){
+	uint16_t first;
+	uint16_t last;
+	for(int page = 0; page < 256; page++){
+		if(get_page_kind(page) != PAGE_MIXED){
+			continue;
+		}
+		//regions in page
+		int start = page << 8;
+		while(start < ((page + 1) << 8)){
+			uint8_t region = get_memory_region(start);
+			int end = start;
+			while((end + 1 < ((page + 1) << 8)) && (get_memory_region(end + 1) == region)){
+				end++;
+			}
+			print_mixed_region(address, write, region, start, end);
+			start = end + 1;
+		}
+		//ROM read by indexed addressing, see print_page_table
+		if(write){
+			continue;
+		}else if(get_rom_range(page, ATTR_ROM_DATA, &first, &last)){
+			printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, first, address, last);
+			printf("\t\t\t\t return pgm_read_byte(&rom[index]);\n");
+			printf("\t\t\t }\n");
+		}else if(get_rom_range(page, ATTR_RRIOT_DATA, &first, &last)){
+			printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, first, address, last);
+			printf("\t\t\t\t return pgm_read_byte(&rriot_rom[index]);\n");
+			printf("\t\t\t }\n");
+		}
+	}
+	printf("\t\t\t break;\n");
+}
+
+/* timer and synchronisation with 6502 time used by write8 and read8 */
+static void
+print_synchronisation(void){
+	//time of Timer1 extended by epoch (overflows), called with interrupts disabled
+	printf("uint32_t\ntimer_ticks(void){\n");
+	printf("\t uint16_t low = TCNT1;\n");
+	printf("\t uint16_t high = epoch;\n");
+	printf("\t if((TIFR1 & (1 << TOV1)) && (low < 0x8000)){\n");
+	printf("\t\t high++;\n");
+	printf("\t }\n");
+	printf("\t return ((uint32_t) high << 16) | low;\n");
+	printf("}\n");
+
+	if(output_queue == 0){
+		//synchronisation of AVR with 6502 before output: the output is due cycles 6502 cycles after the last one,
+		//the CPU sleeps until the compare match of OCR1A (and the overflows before it) wakes it
+		printf("void\nwrite_io(uint8_t value){\n");
+		printf("\t uint8_t sreg = SREG;\n");
+		printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+		printf("\t cycles = 0;\n");
+		printf("\t OCR1A = (uint16_t) deadline;\n");
+		printf("\t TIFR1 = (1 << OCF1A);\n");
+		printf("\t TIMSK1 |= (1 << OCIE1A);\n");
+		printf("\t cli();\n");
+		printf("\t while((int32_t) (deadline - timer_ticks()) > 0){\n");
+		printf("\t\t sleep_enable();\n");
+		printf("\t\t sei();\n");
+		printf("\t\t sleep_cpu();\n");
+		printf("\t\t sleep_disable();\n");
+		printf("\t\t cli();\n");
+		printf("\t }\n");
+		printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+		printf("\t SREG = sreg;\n");
+		printf("\t putChar(value);\n");
+		printf("\t putChar('\\n');\n");
+		printf("}\n\n");
+		return;
+	}
+
+	//run-ahead: outputs wait in queue with the time they are due, release_output prints them in the
+	//compare match ISR of OCR1A while the program goes on, it only waits if the queue is full
+	printf("uint32_t queue_time[OUTPUT_QUEUE_SIZE];\n");
+	printf("uint8_t queue_value[OUTPUT_QUEUE_SIZE];\n");
+	printf("volatile uint8_t queue_head;\n");
+	printf("volatile uint8_t queue_tail;\n\n");
+
+	//called with interrupts disabled, OCIE1A is enabled as long as the queue is not empty
+	printf("void\nrelease_output(void){\n");
+	printf("\t while(queue_tail != queue_head){\n");
+	printf("\t\t uint8_t tail = queue_tail;\n");
+	printf("\t\t OCR1A = (uint16_t) queue_time[tail];\n");
+	printf("\t\t TIMSK1 |= (1 << OCIE1A);\n");
+	printf("\t\t if((int32_t) (queue_time[tail] - timer_ticks()) > 0){\n");
+	printf("\t\t\t return;\n");
+	printf("\t\t }\n");
+	//putChar would drop characters with interrupts disabled: value and newline stay queued until they fit
+	printf("\t\t if(txFree() < 2){\n");
+	printf("\t\t\t OCR1A = TCNT1 + OUTPUT_RETRY_TICKS;\n");
+	printf("\t\t\t return;\n");
+	printf("\t\t }\n");
+	printf("\t\t putChar(queue_value[tail]);\n");
+	printf("\t\t putChar('\\n');\n");
+	printf("\t\t queue_tail = (tail + 1) & OUTPUT_QUEUE_MASK;\n");
+	printf("\t }\n");
+	printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+	printf("}\n\n");
+
+	printf("ISR(TIMER1_COMPA_vect){\n");
+	printf("\t release_output();\n");
+	printf("}\n\n");
+
+	printf("void\nwrite_io(uint8_t value){\n");
+	printf("\t uint8_t sreg = SREG;\n");
+	printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+	printf("\t cycles = 0;\n");
+	printf("\t uint8_t head = queue_head;\n");
+	printf("\t uint8_t next = (head + 1) & OUTPUT_QUEUE_MASK;\n");
+	printf("\t cli();\n");
+	printf("\t while(next == queue_tail){\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t queue_time[head] = deadline;\n");
+	printf("\t queue_value[head] = value;\n");
+	printf("\t queue_head = next;\n");
+	printf("\t release_output();\n");
+	printf("\t SREG = sreg;\n");
+	printf("}\n\n");
+
+	//input is read at its time: the outputs before it are released, then the CPU sleeps until it is due
+	printf("void\nsync_io(void){\n");
+	printf("\t uint8_t sreg = SREG;\n");
+	printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+	printf("\t cycles = 0;\n");
+	printf("\t cli();\n");
+	printf("\t while(queue_tail != queue_head){\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t OCR1A = (uint16_t) deadline;\n");
+	printf("\t TIFR1 = (1 << OCF1A);\n");
+	printf("\t while((int32_t) (deadline - timer_ticks()) > 0){\n");
+	printf("\t\t TIMSK1 |= (1 << OCIE1A);\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+	printf("\t SREG = sreg;\n");
+	printf("}\n\n");
+
+	//runs when main returns, before exit disables interrupts and before USART_Flush of serialCom.c
+	printf("__attribute__((destructor)) void\nflush_output(void){\n");
+	printf("\t while((SREG & (1 << SREG_I)) && (queue_tail != queue_head));\n");
+	printf("}\n\n");
 }
-/* possible Helper Functions for Programm Execution */
 
-void
+static void
 write8(void){
-	printf("void\nwrite8(uint16_t address, uint8_t value){\n");
-	printf("\t if((address >= OUTPUT_MIN) && (address <= OUTPUT_MAX)){\n");
-        printf("\t\t uint32_t avrCycles = ((uint32_t) overflow << 16) | TCNT1;\n");
-        printf("\t\t TCNT1 = 0;\n");
-        printf("\t\t uint32_t time = (cycles * 16) - avrCycles;\n");
-        printf("\t\t overflow = time >> 16;\n");
-        printf("\t\t time = 0xffff - (time & 0xffff);\n");
-        printf("\t\t ioValue = value;\n");
-        printf("\t\t io = 1;\n");
-        printf("\t\t wait = 1;\n");
-        printf("\t\t TCNT1 += time;\n");
-        printf("\t\t while(wait);\n");
-        printf("\t\t TCNT1 = 0;\n");
-        printf("\t\t cycles = 0;\n");
-        printf("\t\t overflow = 0;\n");
-        printf("\t\t io = 0;\n");
-        printf("\t }else if((address >= RAM_MIN) && (address <= RAM_MAX)){\n");
-        printf("\t\t m[address] = value;\n");
-        printf("\t }\n");
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+
+	printf("void\nwrite8%s(uint16_t address, uint8_t value){\n", (count > 0) ? "_memory" : "");
+	printf("\t uint8_t page = address >> 8;\n");
+	printf("\t switch(pgm_read_byte(&page_kind[page])){\n");
+	printf("\t\t case PAGE_RAM:\n");
+	printf("\t\t\t m[pgm_read_word(&page_base[page]) + (address & 0xff)] = value;\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_RRIOT:\n");
+	printf("\t\t\t rriot_ram[pgm_read_word(&page_base[page]) + (address & 0xff)] = value;\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_IO:\n");
+	printf("\t\t\t write_io(value);\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_MIXED:\n");
+	print_mixed_pages("address", 1);
+	printf("\t }\n");
 	printf("}\n");
+	if(count > 0){
+		printf("static inline __attribute__((always_inline)) void\nwrite8(uint16_t address, uint8_t value){\n");
+		for(int i = 0; i < count; i++){
+			printf("\t if(address == %d){\n", promoted[i]);
+			printf("\t\t zp_%x = value;\n", promoted[i]);
+			printf("\t\t return;\n");
+			printf("\t }\n");
+		}
+		printf("\t write8_memory(address, value);\n");
+		printf("}\n");
+	}
 
 }
 
-void
+static void
 read8(void){
-	printf("uint8_t\nread8(uint16_t addr){\n");
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+
+	printf("uint8_t\nread8%s(uint16_t addr){\n", (count > 0) ? "_memory" : "");
+	printf("\t uint8_t page = addr >> 8;\n");
+	printf("\t uint16_t index = pgm_read_word(&page_base[page]) + (addr & 0xff);\n");
+	printf("\t switch(pgm_read_byte(&page_kind[page])){\n");
 	//m represents RAM
-	printf("\t if((addr >= RAM_MIN) && (addr <= RAM_MAX)){\n");
-        printf("\t\t return m[addr];\n");
-        printf("\t }else if((addr >= %d) && (addr <= %d)){\n", RRIOT_RAM_START, RRIOT_ROM_START);
-        printf("\t\t return rriot_ram[addr ^ %d];\n", RRIOT_RAM_START);
-	if(rom_addr > 0){
-		printf("\t }else if((addr >= ROM_MIN) && (addr <= %d)){\n", get_max_rom());
-		printf("\t\t return rom[addr ^ ROM_MIN];\n");
-	}
-	if(rriot_addr > 0){
-		printf("\t }else if((addr >= RRIOT_MIN) && (addr <= %d)){\n", get_max_rriot());
-                printf("\t\t return rom[addr ^ RRIOT_MIN];\n");
+	printf("\t\t case PAGE_RAM:\n");
+	printf("\t\t\t return m[index];\n");
+	printf("\t\t case PAGE_RRIOT:\n");
+	printf("\t\t\t return rriot_ram[index];\n");
+	printf("\t\t case PAGE_IO:\n");
+	if(output_queue > 0){
+		printf("\t\t\t sync_io();\n");
+	}
+	printf("\t\t\t return 0;\n");
+	printf("\t\t case PAGE_MIXED:\n");
+	print_mixed_pages("addr", 0);
+	if(has_rom_table(ATTR_ROM_DATA)){
+		printf("\t\t case PAGE_ROM:\n");
+		printf("\t\t\t return pgm_read_byte(&rom[index]);\n");
+	}
+	if(has_rom_table(ATTR_RRIOT_DATA)){
+		printf("\t\t case PAGE_RRIOT_ROM:\n");
+		printf("\t\t\t return pgm_read_byte(&rriot_rom[index]);\n");
 	}
 	printf("\t }\n");
-        printf("\t return 0;\n");
-        printf("}\n");
+	printf("\t return 0;\n");
+	printf("}\n");
+	if(count > 0){
+		//indexed and indirect accesses may reach promoted bytes
+		printf("static inline __attribute__((always_inline)) uint8_t\nread8(uint16_t addr){\n");
+		for(int i = 0; i < count; i++){
+			printf("\t if(addr == %d){\n", promoted[i]);
+			printf("\t\t return zp_%x;\n", promoted[i]);
+			printf("\t }\n");
+		}
+		printf("\t return read8_memory(addr);\n");
+		printf("}\n");
+	}
 }
 
-void
+static void
 setflag(void){
         printf("void\nsetflag(int flag, uint8_t value){\n");
 	printf("\t if(value == 0){\n");
@@ -508,15 +958,15 @@ setflag(void){
         printf("}");
 }
 
-void
+static void
 pull8(void){
 	printf("uint8_t\npull8(void){\n");
 	printf("\t rs++;\n");
-	printf("\t return m[0x0100 + rs];\n");
+	printf("\t return m[%d + rs];\n", get_region_index(0x0100));
 	printf("}\n");
 }
 
-void
+static void
 push8(void){
 	printf("void\npush8(uint8_t value){\n");
 	printf("\t write8(0x100+rs, value);\n");
@@ -526,7 +976,7 @@ push8(void){
 
 /* Instructions */
 
-void ADC(void){ //ADC... add memory to accumulator with carry
+static void ADC(void){ //ADC... add memory to accumulator with carry
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF) | (1 << CF);
 		uses = (1 << CF);
@@ -542,9 +992,8 @@ void ADC(void){ //ADC... add memory to accumulator with carry
 		if(is_absolute_address(m[pc])){
 			printf("\t __asm__ volatile(\"adc %%0, %%1\" : \"=r\"(ra) : \"r\"((uint8_t) ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+				print_read8();
+                                printf("));\n");
                                 toSet = IR;
 			}else{
 				printf("%d));\n", (uint8_t) m[parameter]);
@@ -555,7 +1004,7 @@ void ADC(void){ //ADC... add memory to accumulator with carry
 	}
 }
 
-void AND(void){ //AND Memory with accumulator
+static void AND(void){ //AND Memory with accumulator
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF); 
 		uses = 0;
@@ -573,9 +1022,8 @@ void AND(void){ //AND Memory with accumulator
 		if(is_absolute_address(m[pc])){
 			printf("\t __asm__ volatile(\"and %%0, %%1\" : \"=r\"(ra) : \"r\"(");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+				print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf("%d));\n", m[parameter]);
@@ -590,7 +1038,7 @@ void AND(void){ //AND Memory with accumulator
 	}
 }
 
-void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
+static void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0; 
@@ -620,9 +1068,9 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
                         }
 			//set CF Flag
 			if(!optimization || (defs & (1 << CF))){
-				printf("\t temp = read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(") & 0x80);\n");
+				printf("\t temp = ");
+				print_read8();
+				printf(" & 0x80);\n");
 				printf("\t if(temp){\n");
 				printf("\t\t __asm__ volatile(\"sec\");\n");
 				printf("\t }else{\n");
@@ -638,7 +1086,7 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
 	}
 }
 
-void BCC(void){ //BCC... branch on carry clean (CF == 0)
+static void BCC(void){ //BCC... branch on carry clean (CF == 0)
         if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << CF);
@@ -646,16 +1094,15 @@ void BCC(void){ //BCC... branch on carry clean (CF == 0)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BCC\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-		printf("\t if(!(SREG & (1 << %d))){\n", CF);     
-                printf("\t\t goto L%x;\n", parameter);
+		printf("\t if(!(temp & (1 << %d))){\n", CF);
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
 		printf("\t }\n");
-      		
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BCS(void){ //BCS... branch on carry set (CF == 1)
+static void BCS(void){ //BCS... branch on carry set (CF == 1)
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << CF);
@@ -663,15 +1110,15 @@ void BCS(void){ //BCS... branch on carry set (CF == 1)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BCS\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-                printf("\t if(SREG & (1 << %d)){\n", CF);
-                printf("\t goto L%x;\n", parameter);
-                printf("\t }\n");
+		printf("\t if(temp & (1 << %d)){\n", CF);
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BEQ(void){ //Branch on result zero (ZF == 1)
+static void BEQ(void){ //Branch on result zero (ZF == 1)
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << ZF);
@@ -679,144 +1126,75 @@ void BEQ(void){ //Branch on result zero (ZF == 1)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BEQ\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-		printf("\t if(SREG & (1 << %d)){\n", ZF);
-                printf("\t\t goto L%x;\n", parameter);
-        	printf("\t }\n");
+		printf("\t if(temp & (1 << %d)){\n", ZF);
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BIT(void){ //BIT... Test Bits in Memory with accumulator
+static void BIT(void){ //BIT... Test Bits in Memory with accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF);
 		uses = 0;
+		add_used_helper_function(read8);
+		usedRegisters = (1 << RA);
         }else if(toSet == IR){
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BIT\n");
-		if(optimization){
-			if(uses & (1 << CF)){
-				printf("\t temp = (1 << 0);\n");
-        			printf("\t __asm__ volatile(\"and %%0, %%1\" : \"=r\"(temp) : \"r\"(SREG));\n");
-        			printf("\t __asm__ volatile(\"bst %%0, 0\" : : \"r\"(temp));\n");
-			}
-                        if(defs & (1 << ZF)){
-                                printf("\t if(ra & ");
-				if(toSet == DYNAMIC){
-					printf("read8(");
-                                	call_corresponding_addressingMode(m[pc]);
-                               	 	printf(")){\n");
-                                	toSet = IR;
-				}else{
-					printf("%d){\n", m[parameter]);
-				}
-                		printf("\t\t __asm__ volatile(\"clz\");\n");
-        			printf("\t }else{\n");
-                		printf("\t\t __asm__ volatile(\"sez\");\n");
-        			printf("\t }\n");
-
-                        }
-                        if(defs & (1 << NF)){
-                                printf("\t if(");
-				if(toSet == DYNAMIC){
-                                        printf("read8(");
-                                        call_corresponding_addressingMode(m[pc]);
-                                        printf(")");
-                                        toSet = IR;
-                                }else{
-                                        printf("%d", m[parameter]);
-                                }
-                                printf(" & (1 << 7)){\n");
-                		printf("\t\t __asm__ volatile(\"sen\");\n");
-        			printf("\t }else{\n");
-                		printf("\t\t __asm__ volatile(\"cln\");\n");
-        			printf("\t }\n");
-                        }
-                        if(defs & (1 << VF)){
-                                printf("\t if(");
-				if(toSet == DYNAMIC){
-                                	printf("read8(");
-                               		call_corresponding_addressingMode(m[pc]);
-                                	printf(")");
-                                	toSet = IR;
-                        	}else{
-                                	printf("%d", m[parameter]);
-                        	}
-				printf(" & (1 << 6)){\n");
-                                printf("\t\t __asm__ volatile(\"sev\");\n");
-                                printf("\t }else{\n");
-                                printf("\t\t __asm__ volatile(\"clv\");\n");
-                                printf("\t }\n");
-                        }
-			if(uses & (1 << CF)){
-				printf("\t __asm__ volatile(\"bld %%0, 0\" : \"=r\"(temp) : );\n");
-        			printf("\t if((temp & (1 << 0)) == 1){\n");
-                		printf("\t\t __asm__ volatile(\"sec\");\n");
-        			printf("\t }else{\n");
-                		printf("\t\t __asm__ volatile(\"clc\");\n");
-        			printf("\t }\n");
-			}
-                }else{
+		uint8_t keep_carry = !optimization || (uses & (1 << CF));
+		if(keep_carry){
 			//save CF Flag
-                        printf("\t temp = (1 << 0);\n");
-                        printf("\t __asm__ volatile(\"and %%0, %%1\" : \"=r\"(temp) : \"r\"(SREG));\n");
-	                printf("\t __asm__ volatile(\"bst %%0, 0\" : : \"r\"(temp));\n");
+			printf("\t temp = (1 << 0);\n");
+			printf("\t __asm__ volatile(\"and %%0, %%1\" : \"=r\"(temp) : \"r\"(SREG));\n");
+			printf("\t __asm__ volatile(\"bst %%0, 0\" : : \"r\"(temp));\n");
+		}
+		//operand is read once, it may be an I/O register
+		printf("\t temp = ");
+		if(toSet == DYNAMIC){
+			print_read8();
+			toSet = IR;
+		}else{
+			printf("%d", m[parameter]);
+		}
+		printf(";\n");
+		if(!optimization || (defs & (1 << ZF))){
 			//ZF = RA & m[parameter]
-			printf("\t if(ra & ");
-			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")){\n");
-                                toSet = IR;
-			}else{	
-				printf("%d){\n", m[parameter]);
-			}
-                        printf("\t\t __asm__ volatile(\"clz\");\n");
-                        printf("\t }else{\n");
-                        printf("\t\t __asm__ volatile(\"sez\");\n");
-                        printf("\t }\n");
+			printf("\t if(ra & temp){\n");
+			printf("\t\t __asm__ volatile(\"clz\");\n");
+			printf("\t }else{\n");
+			printf("\t\t __asm__ volatile(\"sez\");\n");
+			printf("\t }\n");
+		}
+		if(!optimization || (defs & (1 << NF))){
 			//NF = m[parameter] & (1 << 7)
-			printf("\t if(");
-			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
-                                toSet = IR;
-			}else{
-				printf("%d", m[parameter]); 
-			}
-			printf(" & (1 << 7)){\n");
-                        printf("\t\t __asm__ volatile(\"sen\");\n");
-                        printf("\t }else{\n");
-                        printf("\t\t __asm__ volatile(\"cln\");\n");
-                        printf("\t }\n");
-			//VF 
-			printf("\t if(");
-		       	if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
-                                toSet = IR;
-			}else{	
-				printf("%d", m[parameter]);
-			}
-			printf(" & (1 << 6)){\n");
-                        printf("\t\t __asm__ volatile(\"sev\");\n");
-                        printf("\t }else{\n");
-                        printf("\t\t __asm__ volatile(\"clv\");\n");
-                        printf("\t }\n");
+			printf("\t if(temp & (1 << 7)){\n");
+			printf("\t\t __asm__ volatile(\"sen\");\n");
+			printf("\t }else{\n");
+			printf("\t\t __asm__ volatile(\"cln\");\n");
+			printf("\t }\n");
+		}
+		if(!optimization || (defs & (1 << VF))){
+			//VF = m[parameter] & (1 << 6)
+			printf("\t if(temp & (1 << 6)){\n");
+			printf("\t\t __asm__ volatile(\"sev\");\n");
+			printf("\t }else{\n");
+			printf("\t\t __asm__ volatile(\"clv\");\n");
+			printf("\t }\n");
+		}
+		if(keep_carry){
 			printf("\t __asm__ volatile(\"bld %%0, 0\" : \"=r\"(temp) : );\n");
-                        printf("\t if((temp & (1 << 0)) == 1){\n");
-                        printf("\t\t __asm__ volatile(\"sec\");\n");
-                        printf("\t }else{\n");
-                        printf("\t\t __asm__ volatile(\"clc\");\n");
-                        printf("\t }\n");
-		}               
-
+			printf("\t if((temp & (1 << 0)) == 1){\n");
+			printf("\t\t __asm__ volatile(\"sec\");\n");
+			printf("\t }else{\n");
+			printf("\t\t __asm__ volatile(\"clc\");\n");
+			printf("\t }\n");
+		}
 	}
 }
 
-void BMI(void){ //BMI... Branch on result Minus (NF == 1)
+static void BMI(void){ //BMI... Branch on result Minus (NF == 1)
 	if(toSet == DEFS){
 		defs = 0;
                 uses = (1 << NF);
@@ -824,15 +1202,15 @@ void BMI(void){ //BMI... Branch on result Minus (NF == 1)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BMI\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-                printf("\t if(SREG & (1 << 2)){\n");
-                printf("\t\t goto L%x;\n", parameter);
-                printf("\t }\n");
+		printf("\t if(temp & (1 << 2)){\n");
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BNE(void){ //Branch on result not zero (ZF == 0)
+static void BNE(void){ //Branch on result not zero (ZF == 0)
       	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << ZF);
@@ -840,15 +1218,15 @@ void BNE(void){ //Branch on result not zero (ZF == 0)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BNE\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-                printf("\t if(!(SREG & (1 << %d))){\n", ZF);
-                printf("\t\t goto L%x;\n", parameter);
-                printf("\t }\n");
+		printf("\t if(!(temp & (1 << %d))){\n", ZF);
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BPL(void){ //BPL... Branch on Result Plus (NF == 0) 
+static void BPL(void){ //BPL... Branch on Result Plus (NF == 0) 
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << NF);
@@ -856,15 +1234,15 @@ void BPL(void){ //BPL... Branch on Result Plus (NF == 0)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BPL\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-		printf("\t if(!(SREG & (1 << 2))){\n"); 
-                printf("\t\t goto L%x;\n", parameter);
-        	printf("\t }\n");
+		printf("\t if(!(temp & (1 << 2))){\n");
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BRK(void){ //BRK is a software interrupt
+static void BRK(void){ //BRK is a software interrupt
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << BF)|(1 << XX)|(1 << IF);
@@ -873,7 +1251,7 @@ void BRK(void){ //BRK is a software interrupt
 	}
 }
 
-void BVC(void){ //BVC... Branch on Overflow Clear (VF == 0)
+static void BVC(void){ //BVC... Branch on Overflow Clear (VF == 0)
 	if(toSet == DEFS){
 		uses = (1 << VF);
 		defs = 0;
@@ -881,28 +1259,31 @@ void BVC(void){ //BVC... Branch on Overflow Clear (VF == 0)
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BVC\n");
 		printf("\t temp = SREG;\n");
-                printf("\t cycles += %d;\n", cycles);
-                printf("\t SREG = temp;\n");
-                printf("\t if(!(SREG & (1 << 3))){\n");
-                printf("\t\t goto L%x;\n", parameter);
-                printf("\t }\n");
+		printf("\t if(!(temp & (1 << 3))){\n");
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void BVS(void){ //BVS... Branch on Overflow Set (VF == 1)
+static void BVS(void){ //BVS... Branch on Overflow Set (VF == 1)
 	if(toSet == DEFS){
 		uses = (1 << VF);
 		defs = 0;
         }else if(toSet == IR){
 		call_corresponding_addressingMode(m[pc]);
 		printf("\t //BVS\n");
-                printf("\t if(SREG & (1 << 3)){\n");
-                printf("\t\t goto L%x;\n", parameter);
-                printf("\t }\n");
+		printf("\t temp = SREG;\n");
+		printf("\t if(temp & (1 << 3)){\n");
+		print_branch_cycles("\t\t", cycles_taken);
+		printf("\t\t goto L%x;\n", parameter);
+		printf("\t }\n");
+		print_branch_cycles("\t", cycles);
 	}
 }
 
-void CLC(void){ //CLC... clear carry flag
+static void CLC(void){ //CLC... clear carry flag
 	if(toSet == DEFS){
 		defs = (1 << CF);
 		uses = 0;
@@ -911,7 +1292,7 @@ void CLC(void){ //CLC... clear carry flag
 	}
 }
 
-void CLD(void){ //CLD... clear decimal mode
+static void CLD(void){ //CLD... clear decimal mode
 	if(toSet == DEFS){
 		defs = (1 << DF);
 		uses = 0;
@@ -922,7 +1303,7 @@ void CLD(void){ //CLD... clear decimal mode
 	}
 }
 
-void CLI(void){ //Clear Interrupt Disable Bit
+static void CLI(void){ //Clear Interrupt Disable Bit
 	if(toSet == DEFS){
 		defs = (1 << IF);
 		uses = 0;
@@ -931,7 +1312,7 @@ void CLI(void){ //Clear Interrupt Disable Bit
 	}
 }
 
-void CLV(void){ //CLV... clear overflow flag
+static void CLV(void){ //CLV... clear overflow flag
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << VF);
@@ -940,7 +1321,7 @@ void CLV(void){ //CLV... clear overflow flag
 	}
 }
 
-void CMP(void){ //CMP... compare memory with accumulator
+static void CMP(void){ //CMP... compare memory with accumulator
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
 	       	uses = 0;
@@ -958,9 +1339,8 @@ void CMP(void){ //CMP... compare memory with accumulator
 		if(is_absolute_address(m[pc])){
 			printf("\t __asm__ volatile(\"cp %%0, %%1\" : \"=r\"(ra) : \"r\"((uint8_t)");
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
 			}else{
 				printf(" %d));\n", (uint8_t) m[parameter]);
@@ -976,7 +1356,7 @@ void CMP(void){ //CMP... compare memory with accumulator
         }
 }
 
-void CPX(void){ //CPX... compare Memory with Index X
+static void CPX(void){ //CPX... compare Memory with Index X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0;
@@ -994,9 +1374,8 @@ void CPX(void){ //CPX... compare Memory with Index X
                 if(is_absolute_address(m[pc])){
                         printf("\t __asm__ volatile(\"cp %%0, %%1\" : \"=r\"(rx) : \"r\"((uint8_t)");
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf(" %d));\n", (uint8_t) m[parameter]);
@@ -1013,7 +1392,7 @@ void CPX(void){ //CPX... compare Memory with Index X
 	}
 }
 
-void CPY(void){ //CPY... compare Memory with Index Y
+static void CPY(void){ //CPY... compare Memory with Index Y
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0;
@@ -1031,9 +1410,8 @@ void CPY(void){ //CPY... compare Memory with Index Y
                 if(is_absolute_address(m[pc])){
                         printf("\t __asm__ volatile(\"cp %%0, %%1\" : \"=r\"(ry) : \"r\"((uint8_t)");
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf(" %d));\n", (uint8_t) m[parameter]);
@@ -1041,9 +1419,8 @@ void CPY(void){ //CPY... compare Memory with Index Y
                 }else{
                         printf("\t __asm__ volatile(\"cp %%0, %%1\" : \"=r\"(ry) : \"r\"((uint8_t)"); 
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));");
+                                print_read8();
+                                printf("));");
                                 toSet = IR;
                         }else{
 				printf(" %d));\n", (uint8_t) m[parameter]);
@@ -1058,7 +1435,7 @@ void CPY(void){ //CPY... compare Memory with Index Y
 	}
 }
 
-void DEC(void){ //Decrement Memory by one
+static void DEC(void){ //Decrement Memory by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1072,19 +1449,15 @@ void DEC(void){ //Decrement Memory by one
                         return;
                 }
 
-		if((parameter >= RRIOT_RAM_START) && (parameter < RRIOT_ROM_START)){
-			printf("\t rriot_ram[");
-		}else{
-			printf("\t m[");
-		}
-		call_corresponding_addressingMode(m[pc]);
-		printf("]--;\n");
+		printf("\t ");
+		print_memory_operand();
+		printf("--;\n");
 		set_NF_ZF_for_memory();
 		toSet = IR;
 	}
 }
 
-void DEX(void){ //Decrement Index X by one
+static void DEX(void){ //Decrement Index X by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1102,7 +1475,7 @@ void DEX(void){ //Decrement Index X by one
 	}
 }
 
-void DEY(void){ //Decrement Index Y by one
+static void DEY(void){ //Decrement Index Y by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1119,7 +1492,7 @@ void DEY(void){ //Decrement Index Y by one
 	}
 }
 
-void EOR(void){ //Exclusive-OR Memory with Accumulator
+static void EOR(void){ //Exclusive-OR Memory with Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1138,9 +1511,8 @@ void EOR(void){ //Exclusive-OR Memory with Accumulator
 		if(is_absolute_address(m[pc]) == 1){
                         printf("\t __asm__ volatile(\"eor %%0, %%1\" : \"=r\"(ra) : \"r\"("); 
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf("%d));\n", m[parameter]);
@@ -1154,7 +1526,7 @@ void EOR(void){ //Exclusive-OR Memory with Accumulator
 	}
 }
 
-void INC(void){ //Increment Memory by one
+static void INC(void){ //Increment Memory by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1168,19 +1540,15 @@ void INC(void){ //Increment Memory by one
 	                return;
                 }
 		
-		if((parameter >= RRIOT_RAM_START) && (parameter < RRIOT_ROM_START)){
-			printf("\t rriot_ram[");
-		}else{
-			printf("\t m[");
-		}
-		call_corresponding_addressingMode(m[pc]);
-		printf("]++;\n");
+		printf("\t ");
+		print_memory_operand();
+		printf("++;\n");
 		set_NF_ZF_for_memory();
 		toSet = IR;
 	}
 }
 
-void INX(void){ //Increment Index X by one
+static void INX(void){ //Increment Index X by one
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
@@ -1199,7 +1567,7 @@ void INX(void){ //Increment Index X by one
 	}
 }
 
-void INY(void){ //Increment Index Y by one
+static void INY(void){ //Increment Index Y by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1217,24 +1585,26 @@ void INY(void){ //Increment Index Y by one
 	}
 }
 
-void JMP(void){ //Jump to address
+static void JMP(void){ //Jump to address
         if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
 	}else if(toSet == IR){
 		printf("\t //JMP\n");
 		call_corresponding_addressingMode(m[pc]);
-                if(toSet == DYNAMIC){
-                        exit(1);
+                if((toSet == DYNAMIC) && (m[pc] == 0x6C)){
+			//no code for target, program stops like at BRK (see is_dynamic_jump)
+			printf("\t //vector %x in RAM, target not known at translation time\n", parameter);
+			printf("\t __asm__ volatile(\"ret\");\n");
                 }else{
-                        printf("\t cycles += %d;\n", cycles);
+                        print_add_cycles(cycles);
                         printf("\t goto L%x;\n", parameter);
 
                 }
 	}
 }
 
-void JSR(void){ //Jump to subroutine
+static void JSR(void){ //Jump to subroutine
 	if(toSet == DEFS){
 		defs = 0;
                 uses = 0;
@@ -1250,12 +1620,12 @@ void JSR(void){ //Jump to subroutine
         }else if(toSet == IR){
 		printf("\t //JSR\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t cycles += %d;\n", cycles); 
+		print_add_cycles(cycles);
 		printf("\t __asm__ volatile(\"rcall L%x\");\n", parameter);
 	}
 }
 
-void LDA(void){ //LDA... Load Accumulator with memory
+static void LDA(void){ //LDA... Load Accumulator with memory
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
@@ -1271,9 +1641,8 @@ void LDA(void){ //LDA... Load Accumulator with memory
 		if(is_absolute_address(m[pc])){
 			printf("\t __asm__ volatile(\"mov %%0, %%1\" : \"=r\"(ra) : \"r\"((uint8_t)");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                        	printf(")));\n");
+				print_read8();
+                        	printf("));\n");
 				toSet = IR;
 			}else{
 		       		printf("%d));\n", m[parameter]);
@@ -1287,7 +1656,7 @@ void LDA(void){ //LDA... Load Accumulator with memory
 	}
 }
 
-void LDX(void){ //LDX... Load Index X with memory
+static void LDX(void){ //LDX... Load Index X with memory
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
@@ -1302,9 +1671,8 @@ void LDX(void){ //LDX... Load Index X with memory
 		if(is_absolute_address(m[pc])){
                         printf("\t __asm__ volatile(\"mov %%0, %%1\" : \"=r\"(rx) : \"r\"((uint8_t)"); 
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+				print_read8();
+                                printf("));\n");
                                 toSet = IR;
 			}else{
 				printf("%d));\n", m[parameter]);
@@ -1318,7 +1686,7 @@ void LDX(void){ //LDX... Load Index X with memory
 	}
 }
 
-void LDY(void){ //LDY... Load Index Y with memory
+static void LDY(void){ //LDY... Load Index Y with memory
 	if(toSet == DEFS){
                 defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1333,9 +1701,8 @@ void LDY(void){ //LDY... Load Index Y with memory
 		if(is_absolute_address(m[pc])){
                         printf("\t __asm__ volatile(\"mov %%0, %%1\" : \"=r\"(ry) : \"r\"((uint8_t)"); 
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+				print_read8();
+                                printf("));\n");
                                 toSet = IR;
 			}else{
 				printf("%d));\n", m[parameter]);
@@ -1349,7 +1716,7 @@ void LDY(void){ //LDY... Load Index Y with memory
 	}
 }
 
-void LSR(void){ //Shift One Bit Right (Memory or accumulator)
+static void LSR(void){ //Shift One Bit Right (Memory or accumulator)
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << NF) | (1 << ZF);
@@ -1378,9 +1745,8 @@ void LSR(void){ //Shift One Bit Right (Memory or accumulator)
 
 		if(!optimization || (defs & (1 << CF))){        
 			printf("\t temp = ");
-                        printf("read8(");
-                        call_corresponding_addressingMode(m[pc]);
-                        printf(") & 0x1;\n");
+                        print_read8();
+                        printf(" & 0x1;\n");
 			printf("\t if(temp){\n");
 			printf("\t\t __asm__ volatile(\"sec\");\n");
 			printf("\t }else{\n");
@@ -1395,7 +1761,7 @@ void LSR(void){ //Shift One Bit Right (Memory or accumulator)
 	}
 }
 
-void NOP(void){
+static void NOP(void){
 	if(toSet == DEFS){
 		uses = 0;
 		defs = 0;
@@ -1407,7 +1773,7 @@ void NOP(void){
 	}
 }
 
-void ORA(void){ //OR Memory with Accumulator 
+static void ORA(void){ //OR Memory with Accumulator 
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << NF) | (1 << ZF);
@@ -1427,9 +1793,8 @@ void ORA(void){ //OR Memory with Accumulator
 		if(is_absolute_address(m[pc]) == 1){
 			printf("\t __asm__ volatile(\"or %%0, %%1\" : \"=r\"(ra) : \"r\"("); 
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf("%d));\n", m[parameter]);
@@ -1445,7 +1810,7 @@ void ORA(void){ //OR Memory with Accumulator
 	}
 }
 
-void PHA(void){ //PusH Accumulator
+static void PHA(void){ //PusH Accumulator
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -1458,7 +1823,7 @@ void PHA(void){ //PusH Accumulator
 	}
 }
 
-void PHP(void){ //PusH Processor status
+static void PHP(void){ //PusH Processor status
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -1471,7 +1836,7 @@ void PHP(void){ //PusH Processor status
 	}
 }
 
-void PLA(void){ //PuLl Accumulator
+static void PLA(void){ //PuLl Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1484,7 +1849,7 @@ void PLA(void){ //PuLl Accumulator
 	}
 }
 
-void PLP(void){ //PuLl Processor status
+static void PLP(void){ //PuLl Processor status
 	if(toSet == DEFS){
 		defs = (1 << BF) | (1 << XX);
                 uses = 0;
@@ -1498,7 +1863,7 @@ void PLP(void){ //PuLl Processor status
 	}
 }
 
-void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
+static void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
@@ -1528,9 +1893,9 @@ void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
                 	}
 
 			if(!optimization || (defs & (1 << CF))){
-                        	printf("\t temp = (read8(");
-                        	call_corresponding_addressingMode(m[pc]);
-                        	printf(") & 0x80) >> 7;\n");
+                        	printf("\t temp = (");
+                        	print_read8();
+                        	printf(" & 0x80) >> 7;\n");
 			}
                         
 			print_ram_or_rriot();
@@ -1549,7 +1914,7 @@ void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
 	}
 }
 
-void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
+static void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
@@ -1581,9 +1946,9 @@ void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
 	                }
 
 			if(!optimization || (defs & (1 << CF))){
-                                printf("\t temp = read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(") & 0x1;\n");
+                                printf("\t temp = ");
+                                print_read8();
+                                printf(" & 0x1;\n");
                         }
 
                         print_ram_or_rriot();
@@ -1604,7 +1969,7 @@ void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
 	}
 }
 
-void RTI(void){ //Return from Interrupt
+static void RTI(void){ //Return from Interrupt
 	if(toSet == DEFS){
 		defs = (1 << BF);
                 uses = 0;
@@ -1614,7 +1979,7 @@ void RTI(void){ //Return from Interrupt
 	}
 }
 
-void RTS(void){ // return from subroutine
+static void RTS(void){ // return from subroutine
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -1625,7 +1990,7 @@ void RTS(void){ // return from subroutine
 	}
 }
 
-void SBC(void){ //SBC... subtract with carry
+static void SBC(void){ //SBC... subtract with carry
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
@@ -1640,9 +2005,8 @@ void SBC(void){ //SBC... subtract with carry
                 if(is_absolute_address(m[pc])){
                         printf("\t __asm__ volatile(\"sbc %%0, %%1\" : \"=r\"(ra) : \"r\"((uint8_t)");
 			if(toSet == DYNAMIC){
-                                printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")));\n");
+                                print_read8();
+                                printf("));\n");
                                 toSet = IR;
                         }else{
 				printf(" %d));\n", (uint8_t) m[parameter]);
@@ -1654,7 +2018,7 @@ void SBC(void){ //SBC... subtract with carry
 	}
 }
 
-void SEC(void){ //SEC... Set Carry Flag
+static void SEC(void){ //SEC... Set Carry Flag
 	if(toSet == DEFS){
 		defs = (1 << CF);
                 uses = 0;
@@ -1665,7 +2029,7 @@ void SEC(void){ //SEC... Set Carry Flag
 	}
 }
 
-void SED(void){ //SED... set decimal flag
+static void SED(void){ //SED... set decimal flag
 	if(toSet == DEFS){
 		defs = (1 << DF);
                 uses = 0;
@@ -1678,7 +2042,7 @@ void SED(void){ //SED... set decimal flag
 	}
 }
 
-void SEI(void){ //Set Interrupt Disable Status
+static void SEI(void){ //Set Interrupt Disable Status
 	if(toSet == DEFS){
 		defs = (1 << BF);
                 uses = 0;
@@ -1690,7 +2054,7 @@ void SEI(void){ //Set Interrupt Disable Status
 
 
 
-void TAX(void){ // Transfer Accumulator to Index X
+static void TAX(void){ // Transfer Accumulator to Index X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1702,7 +2066,7 @@ void TAX(void){ // Transfer Accumulator to Index X
 	}
 }
 
-void TAY(void){ // Transfer Accumulator to Index Y
+static void TAY(void){ // Transfer Accumulator to Index Y
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1714,7 +2078,7 @@ void TAY(void){ // Transfer Accumulator to Index Y
 	}
 }
 
-void TSX(void){ //Transfer Stackpointer to X
+static void TSX(void){ //Transfer Stackpointer to X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1726,7 +2090,7 @@ void TSX(void){ //Transfer Stackpointer to X
 	}
 }
 
-void TXA(void){ // Transfer Index X to  Accumulator
+static void TXA(void){ // Transfer Index X to  Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1738,7 +2102,7 @@ void TXA(void){ // Transfer Index X to  Accumulator
 	}
 }
 
-void TXS(void){ //Transfer X to Stackpointer
+static void TXS(void){ //Transfer X to Stackpointer
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -1750,7 +2114,7 @@ void TXS(void){ //Transfer X to Stackpointer
 	}
 }
 
-void TYA(void){ // Transfer Index Y to  Accumulator
+static void TYA(void){ // Transfer Index Y to  Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -1764,58 +2128,58 @@ void TYA(void){ // Transfer Index Y to  Accumulator
 
 /* "Illegal" Opcodes - not supported by translator */
 
-void ALR(void){ //A AND operand + LSR
+static void ALR(void){ //A AND operand + LSR
 }
 
-void ANC(void){ //A AND operand + set C as ASL
+static void ANC(void){ //A AND operand + set C as ASL
 }
 
-void ANC2(void){ // A AND operand + set C as ROL
+static void ANC2(void){ // A AND operand + set C as ROL
 }
 
-void ARR(void){ //A AND operand + ROR
+static void ARR(void){ //A AND operand + ROR
 }
 
-void DCP(void){ //DEC operand + CMP oper
+static void DCP(void){ //DEC operand + CMP oper
 }
 
-void ISC(void){ //INC operand + SBC operand
+static void ISC(void){ //INC operand + SBC operand
 }
 
-void LAS(void){ //LDA/TSX operand
+static void LAS(void){ //LDA/TSX operand
 }
 
-void LAX(void){ //LDA operand + LDX operand
+static void LAX(void){ //LDA operand + LDX operand
 }
 
-void RLA(void){ //ROL operand + AND operand
+static void RLA(void){ //ROL operand + AND operand
 }
 
-void RRA(void){ //ROR operand + ADC Operand
+static void RRA(void){ //ROR operand + ADC Operand
 }
 
-void SAX(void){ // A and X are put on bus at the same time -> like A AND X
+static void SAX(void){ // A and X are put on bus at the same time -> like A AND X
 }
 
-void SBX(void){ //CMP and DEC at onces
+static void SBX(void){ //CMP and DEC at onces
 }
 
-void SLO(void){ //ASL operand + ORA operand
+static void SLO(void){ //ASL operand + ORA operand
 }
 
-void SRE(void){ //LSR operand + EOR operand
+static void SRE(void){ //LSR operand + EOR operand
 }
 
-void USBC(void){ //SBC + NOP
+static void USBC(void){ //SBC + NOP
 }
 
-void JAM(void){ //freeze the CPU with $FF on data bus
+static void JAM(void){ //freeze the CPU with $FF on data bus
      	printf("//JAM\n");
 	printf("\t return 0;\n");
 }
 
 /* Instructions */
-void STA(void){ //STA... store accumulator in memory
+static void STA(void){ //STA... store accumulator in memory
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -1845,19 +2209,15 @@ void STA(void){ //STA... store accumulator in memory
                         return;
                	}
 
-		printf("\t write8(");
-                if(toSet == DYNAMIC){
-                	call_corresponding_addressingMode(m[pc]);
-                        printf(", ra);\n");
-                        toSet = IR;
-		}else{
-                	printf("%d, ra);\n", parameter);
-                }
+		print_store_begin();
+		printf("ra");
+		print_store_end();
+		toSet = IR;
 		printf("\t SREG = temp;\n");
 	}
 }
 
-void STX(void){ //STA... store Index X in memory
+static void STX(void){ //STA... store Index X in memory
         if(toSet == DEFS){
                 defs = 0;
                 uses = 0;
@@ -1886,19 +2246,15 @@ void STX(void){ //STA... store Index X in memory
                         return;
                 }
                 
-		printf("\t write8(");
-                if(toSet == DYNAMIC){
-                	call_corresponding_addressingMode(m[pc]);
-                        printf(", rx);\n");
-                        toSet = IR;
-                }else{
-                        printf("%d, rx);\n", parameter);
-                }
+		print_store_begin();
+		printf("rx");
+		print_store_end();
+		toSet = IR;
 		printf("\t SREG = temp;\n");
 	}
 }
 
-void STY(void){ //STA... store Index Y in memory
+static void STY(void){ //STA... store Index Y in memory
         if(toSet == DEFS){
                 defs = 0;
                 uses = 0;
@@ -1928,99 +2284,59 @@ void STY(void){ //STA... store Index Y in memory
                         return;
                 }
 
-              	printf("\t write8(");
-                if(toSet == DYNAMIC){
-                	call_corresponding_addressingMode(m[pc]);
-                        printf(", ry);\n");
-                        toSet = IR;
-                }else{
-                        printf("%d, ry);\n", parameter);
-                
-                }
+		print_store_begin();
+		printf("ry");
+		print_store_end();
+		toSet = IR;
 		printf("\t SREG = temp;\n");
 	}
 }
 
 /* Addressing Modes */
-void
+static void
 add_rom_address(uint16_t address){
-	for(int i = 0; i < rom_addr; i++){
-		if(rom_addresses[i] == address){
-			return;
-		}
-	}
-	rom_addresses[rom_addr] = address;
-	rom_addr++;
-	return;
+	//shared by all representations, see print_rom_table
+	address_attributes[address] |= ATTR_ROM_DATA;
 }
 
-void
+static void
 add_rriot_address(uint16_t address){
-	for(int i = 0; i < rriot_addr; i++){
-        	if(rriot_rom[i] == address){
-              		return;
-                }
-        }
-        
-        rriot_rom[rriot_addr] = address;
-        rriot_addr++;
-        return;
+	address_attributes[address] |= ATTR_RRIOT_DATA;
 }
 
-void
+static void
 add_rom_range_to_rom_addresses(uint16_t address){
-	//add range accessible with 8-Bit Register (possible values: -128 to 127)
-	uint16_t start;
-       	uint16_t lowest = address + 0xff80;
-	uint16_t end;
-       	uint32_t highest = address + 0x007f;
-	
-        if(highest > 0xffff){
-                end = 0xffff;
-        }else{
-                end = highest & 0xffff;
-        }
-	start = 0xf000;
-        if((lowest & 0xF000) == 0xF000){
-		//no overflow
-                start = lowest;
-	}
-	
-	for(uint16_t i = start; i <= end; i++){
-		if((i >= start) && (i <= end)){
+	//add range reachable with unsigned 8-Bit index register (address + 0 ... address + 255) which is ROM in memory map
+	int start = address;
+	int end = address + 0xff;
+
+	if(end > 0xffff){
+		end = 0xffff;
+	}
+	for(int i = start; i <= end; i++){
+		if(is_in_ROM(i) && (get_memory_region(i) != REGION_RRIOT_ROM)){
 			add_rom_address(i);
 		}
 	}
 }
 
-void
+static void
 add_rriot_range_to_rom_addresses(uint16_t address){
-	uint16_t start;
-        uint16_t lowest = address + 0xff80;
-        uint16_t end;
-        uint32_t highest = address + 0x007f;
-	//address in RRIOT ROM
-	if(highest > 0x8fff){
-        	end = 0x8fff;
-        }else{
-                end = highest & 0xffff;
-        }
-        start = 0x8c00;
-       	if((lowest & 0x8000) == 0x8000){
-                start = RRIOT_ROM_START;
-        }else{
-                start = lowest;
-        }
-
-	for(uint16_t i = start; i <= end; i++){
-                if((i >= start) && (i <= end)){
-                        add_rriot_address(i);
-                }
-        }
+	//add range reachable with unsigned 8-Bit index register (address + 0 ... address + 255) which is RRIOT ROM in memory map
+	int start = address;
+	int end = address + 0xff;
 
+	if(end > 0xffff){
+		end = 0xffff;
+	}
+	for(int i = start; i <= end; i++){
+		if(get_memory_region(i) == REGION_RRIOT_ROM){
+			add_rriot_address(i);
+		}
+	}
 }
 
-void absolute(void){
+static void absolute(void){
 	if(toSet == BYTES){
 		bytes = 3;
 		parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
@@ -2029,29 +2345,20 @@ void absolute(void){
 	}else{
 		parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
                 bytes = 3;
-                if(((parameter >= RRIOT_RAM_START) && (parameter < RRIOT_ROM_START)) || (parameter <= 0xff)){
+                //only ROM is known at translation time, RAM and I/O are accessed at runtime
+                if(!is_in_ROM(parameter)){
                         toSet = DYNAMIC;
                 }
 	}
 }
 
-void absolute_x (void){ //address is address incremented with X (with carry)
-	static int visits = 0;
+static void absolute_x (void){ //address is address incremented with X (with carry)
 	if(toSet == BYTES){
 		bytes = 3;
-#if WCET
-		cycles++;
-#endif
-		if(visits == 0){
-			parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
-			//save rom range for dynamic access
-			if(parameter >= 0xf000){
-                        	add_rom_range_to_rom_addresses(parameter);
-                	}else{
-                        	add_rriot_range_to_rom_addresses(parameter);
-                	}
-		}
-
+		parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
+		//save rom range for dynamic access
+		add_rom_range_to_rom_addresses(parameter);
+		add_rriot_range_to_rom_addresses(parameter);
 	}else if(toSet == DYNAMIC){
 		printf("%d + rx", parameter);
 	}else{
@@ -2059,26 +2366,15 @@ void absolute_x (void){ //address is address incremented with X (with carry)
 		parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
 		bytes = 3;
 	}
-	visits++;
 }
 
-void absolute_y(void){ //address is address incremented with Y (with carry)
-	static int visits = 0;
+static void absolute_y(void){ //address is address incremented with Y (with carry)
         if(toSet == BYTES){
 		bytes = 3;
-#if WCET
-		cycles++;
-#endif
-		if(visits == 0){
-			parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
-			//save rom range for dynamic access
-                	if(parameter >= 0xf000){
-                        	add_rom_range_to_rom_addresses(parameter);
-                	}else{
-                        	add_rriot_range_to_rom_addresses(parameter);
-                	}
-		}
-
+		parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
+		//save rom range for dynamic access
+        	add_rom_range_to_rom_addresses(parameter);
+        	add_rriot_range_to_rom_addresses(parameter);
 	}else if(toSet == DYNAMIC){
 		printf("%d + ry", parameter);
 	}else{
@@ -2086,10 +2382,9 @@ void absolute_y(void){ //address is address incremented with Y (with carry)
 		parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
 		bytes = 3;
 	}
-	visits++;
 }
 
-void immediate(void){
+static void immediate(void){
 	if(toSet == BYTES){
 		bytes = 2;
 	}else{
@@ -2098,38 +2393,33 @@ void immediate(void){
 	}
 }
 
-void implied(void){
+static void implied(void){
 	bytes = 1;
 }
 
-void indirect(void){
+static void indirect(void){
 	if(toSet == BYTES){
 		bytes = 3;
 	}else{
 		bytes = 3;
-        	uint16_t vector = m[pc+1] | ((uint16_t) m[pc+2] << 8);
+		uint16_t vector = m[pc+1] | ((uint16_t) m[pc+2] << 8);
 		if(is_in_ROM(vector)){
-			parameter = m[vector] | ((uint16_t) m[vector + 1] << 8);
-			if(!is_in_ROM(parameter)){
-				printf("jump address is in RAM!!!\n");
-			       	toSet = DYNAMIC;
-			}
+			//target was followed by code discovery, it has a label
+			parameter = m[vector] | ((uint16_t) m[(uint16_t) (vector + 1)] << 8);
 		}else{
-			printf("jump address is in RAM!!!\n");
+			//vector in RAM: target only known at runtime
+			parameter = vector;
 			toSet = DYNAMIC;
 		}
 	}
-	
 }
 
-void indirect_y(void){
+static void indirect_y(void){
 	if(toSet == BYTES){
-#if WCET
-		cycles++;
-#endif
 		bytes = 2;
 	}else if(toSet == DYNAMIC){
-		printf("(read8(%d) | ((uint16_t) (read8(%d) + 1) << 8)) + ry)", parameter, parameter);
+		//pointer is read from zero page, its high byte wraps around to 0x00
+		printf("((read8(%d) | ((uint16_t) read8(%d) << 8)) + ry)", parameter, (parameter + 1) & 0xff);
 	}else{
 		parameter = m[pc+1];
 		toSet = DYNAMIC;
@@ -2137,11 +2427,12 @@ void indirect_y(void){
 	}
 }
 
-void indexed_x(void){ //pointer is modified with x
+static void indexed_x(void){ //pointer is modified with x
 	if(toSet == BYTES){
         	bytes = 2;
 	}else if(toSet == DYNAMIC){
-		printf("(read8(%d) + rx) | (((uint16_t) (read8(%d) + rx) + 1) << 8)", parameter, parameter);
+		//X is added to address of pointer, pointer stays in zero page
+		printf("(read8((%d + rx) & 0xff) | ((uint16_t) read8((%d + rx + 1) & 0xff) << 8))", parameter, parameter);
 	}else{
 		parameter = m[pc+1];
 		toSet = DYNAMIC;
@@ -2149,7 +2440,7 @@ void indexed_x(void){ //pointer is modified with x
 	}
 }
 
-void relative(void){
+static void relative(void){
 	parameter = m[pc + 1];
 	bytes = 2;
 	if((parameter & 0x80) == 0x80){
@@ -2158,7 +2449,7 @@ void relative(void){
 	parameter = (pc + 2) + parameter;
 }
 
-void zeropage(void){ //hi-byte is 0x00
+static void zeropage(void){ //hi-byte is 0x00
         if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
@@ -2170,7 +2461,7 @@ void zeropage(void){ //hi-byte is 0x00
 	}
 }
 
-void zeropage_x(void){ //address is address incremented with x (without carry)
+static void zeropage_x(void){ //address is address incremented with x (without carry)
 	if(toSet == BYTES){
 		bytes = 2;
 	}else if(toSet == DYNAMIC){
@@ -2182,7 +2473,7 @@ void zeropage_x(void){ //address is address incremented with x (without carry)
 	}
 }
 
-void zeropage_y(void){ //address is address incremented with y (without carry)
+static void zeropage_y(void){ //address is address incremented with y (without carry)
         if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
@@ -2195,3 +2486,47 @@ void zeropage_y(void){ //address is address incremented with y (without carry)
 }
 
 
+
+/* Representation */
+static void
+print_used_helper_functions(void){
+	for(int i = 0; i < helperFunctions; i++){
+		if((used_helper_functions[i] == read8) || (used_helper_functions[i] == write8)){
+			print_page_table();
+			print_synchronisation();
+			break;
+		}
+	}
+	for(int i = 0; i < helperFunctions; i++){
+		(*used_helper_functions[i])();
+		printf("\n\n");
+	}
+}
+
+static void (*opcodes[NUMBER_OF_MNEMONICS])(void) = {
+	[OP_ADC] = ADC, [OP_AND] = AND, [OP_ASL] = ASL, [OP_BCC] = BCC, [OP_BCS] = BCS, [OP_BEQ] = BEQ,
+	[OP_BIT] = BIT, [OP_BMI] = BMI, [OP_BNE] = BNE, [OP_BPL] = BPL, [OP_BRK] = BRK, [OP_BVC] = BVC,
+	[OP_BVS] = BVS, [OP_CLC] = CLC, [OP_CLD] = CLD, [OP_CLI] = CLI, [OP_CLV] = CLV, [OP_CMP] = CMP,
+	[OP_CPX] = CPX, [OP_CPY] = CPY, [OP_DEC] = DEC, [OP_DEX] = DEX, [OP_DEY] = DEY, [OP_EOR] = EOR,
+	[OP_INC] = INC, [OP_INX] = INX, [OP_INY] = INY, [OP_JMP] = JMP, [OP_JSR] = JSR, [OP_LDA] = LDA,
+	[OP_LDX] = LDX, [OP_LDY] = LDY, [OP_LSR] = LSR, [OP_NOP] = NOP, [OP_ORA] = ORA, [OP_PHA] = PHA,
+	[OP_PHP] = PHP, [OP_PLA] = PLA, [OP_PLP] = PLP, [OP_ROL] = ROL, [OP_ROR] = ROR, [OP_RTI] = RTI,
+	[OP_RTS] = RTS, [OP_SBC] = SBC, [OP_SEC] = SEC, [OP_SED] = SED, [OP_SEI] = SEI, [OP_STA] = STA,
+	[OP_STX] = STX, [OP_STY] = STY, [OP_TAX] = TAX, [OP_TAY] = TAY, [OP_TSX] = TSX, [OP_TXA] = TXA,
+	[OP_TXS] = TXS, [OP_TYA] = TYA, [OP_ALR] = ALR, [OP_ANC] = ANC, [OP_ANC2] = ANC2, [OP_ARR] = ARR,
+	[OP_DCP] = DCP, [OP_ISC] = ISC, [OP_LAS] = LAS, [OP_LAX] = LAX, [OP_RLA] = RLA, [OP_RRA] = RRA,
+	[OP_SAX] = SAX, [OP_SBX] = SBX, [OP_SLO] = SLO, [OP_SRE] = SRE, [OP_USBC] = USBC, [OP_JAM] = JAM,
+};
+
+Backend avr_backend = {
+	.name = "avr",
+	.opcodes = opcodes,
+	.addressing_mode = call_corresponding_addressingMode,
+	.prolog = print_prolog,
+	.global_vars_and_functions = print_global_vars_and_functions,
+	.helper_functions = print_used_helper_functions,
+	.main = print_main,
+	.epilog = print_epilog,
+	.add_cycles = print_add_cycles,
+	.delay_loop = print_delay_loop
+};
@@ -2,15 +2,15 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "6502_instructions.h"
+#include "6502_representation.h"
 
 #define MAX_HELPER_FUNCTIONS 9
-#define RRIOT_RAM_START 0x8b80
-#define RRIOT_ROM_START 0x8c00
-#define RRIOT_IO_START 0x8b00
+//promoted zero page bytes are kept in r6 ... r9
+#define PROMOTED_REGISTER 6
 
 extern uint16_t pc;
 extern uint8_t m[65536];
-BinaryInstruction program_blocks[0xffff][255];
+extern uint8_t address_attributes[65536];
 
 extern struct Instructions code[256];
 enum { CF=0, ZF, IF, DF, BF, XX, VF, NF };
@@ -18,32 +18,30 @@ enum { RA=0, RY, RX, RS, TEMP};
 
 /* Communication with Translator*/
 enum{DEFS, IR, BYTES, DYNAMIC};
-uint8_t bytes;
+extern uint16_t parameter; //set by addressing mode
+extern uint8_t bytes;
 
 extern int toSet;
 extern uint8_t defs;
 extern uint8_t uses;
 extern uint8_t usedRegisters;
 extern uint8_t optimization;
+extern uint8_t output_queue; //length of output queue (run-ahead), 0 == write_io waits for output
 extern uint16_t cycles;
+extern uint16_t cycles_taken; //cycles of taken path of conditional branch
 
 extern uint8_t bcd;
 /* communication for printing */
-uint16_t rriot_rom[1024];
-uint16_t rriot_addr;
-uint16_t rom_addresses[4096];
-uint16_t rom_addr;
 
-uint16_t jsr[2048];
-uint16_t jsr_counter;
+static uint16_t jsr[2048];
+static uint16_t jsr_counter;
 
-extern void (*used_helper_functions[9])(void);
-int helperFunctions = 0;
+static void (*used_helper_functions[MAX_HELPER_FUNCTIONS])(void);
+static int helperFunctions = 0;
 
 /* Helper Functions */
-uint16_t parameter; //set by addressing mode
 
-void
+static void
 add_used_helper_function(void (*helper_function)(void)){
 	if(helperFunctions == MAX_HELPER_FUNCTIONS){
 		return;
@@ -58,7 +56,7 @@ add_used_helper_function(void (*helper_function)(void)){
 	}
 }
 
-int
+static int
 is_absolute_address(uint8_t opcode){
 	uint16_t addressingMode = code[opcode].addressingMode;
        	if((addressingMode == 0x9) || (addressingMode == 0x8) || (addressingMode == 0xa)){
@@ -68,13 +66,14 @@ is_absolute_address(uint8_t opcode){
 	}
 }
 
-int
+static int
 is_in_ROM(uint16_t parameter){
-        //in RRIOT_ROM or ROM
-        return ((parameter >= RRIOT_ROM_START) && (parameter <= 0x8FFF)) || ((parameter >= 0xF000) && (parameter <= 0xFFFF));
+	//in RRIOT_ROM or ROM (including tables and vectors) of memory map
+	uint8_t kind = get_memory_region(parameter);
+	return (kind == REGION_RRIOT_ROM) || (kind == REGION_ROM) || (kind == REGION_DATA);
 }
 
-void
+static void
 check_for_indexed_addressing(uint8_t opcode){
         if((code[opcode].addressingMode == 0x15) || (code[opcode].addressingMode == 0x1d) || (code[opcode].addressingMode == 0x1)){
                 //X-Register needed
@@ -85,7 +84,7 @@ check_for_indexed_addressing(uint8_t opcode){
         }
 }
 
-void
+static void
 call_corresponding_addressingMode(uint8_t opcode){
         uint8_t addressingMode = code[opcode].addressingMode;
         switch(addressingMode){
@@ -129,99 +128,240 @@ call_corresponding_addressingMode(uint8_t opcode){
         };
 }
 
-int 
-is_IO_operation(uint16_t address){
-	return ((address >= RRIOT_IO_START) && (address < RRIOT_RAM_START));
+/* memory operand of instruction at pc with address known at translation time,
+ * accessed directly instead of by the generic read8 and write8 */
+enum{ACCESS_MEMORY, ACCESS_RAM, ACCESS_RRIOT_RAM, ACCESS_IO, ACCESS_PROMOTED};
+
+static int
+is_promoted(uint16_t address){
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+	for(int i = 0; i < count; i++){
+		if(promoted[i] == address){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int
+classify_access(void){
+	uint8_t addressingMode = code[m[pc]].addressingMode;
+	if((addressingMode != 0x5) && (addressingMode != 0xd)){
+		//indexed or indirect
+		return ACCESS_MEMORY;
+	}
+	if(is_promoted(parameter)){
+		return ACCESS_PROMOTED;
+	}
+	switch(get_memory_region(parameter)){
+		case REGION_RAM:
+			return ACCESS_RAM;
+		case REGION_RRIOT_RAM:
+			return ACCESS_RRIOT_RAM;
+		case REGION_IO:
+			return ACCESS_IO;
+	}
+	return ACCESS_MEMORY;
+}
+
+static void
+print_read8(void){
+	switch(classify_access()){
+		case ACCESS_PROMOTED:
+			printf("zp_%x", parameter);
+			break;
+		case ACCESS_RAM:
+			printf("m[%d]", get_region_index(parameter));
+			break;
+		case ACCESS_RRIOT_RAM:
+			printf("rriot_ram[%d]", get_region_index(parameter));
+			break;
+		default:
+			printf("read8(");
+			call_corresponding_addressingMode(m[pc]);
+			printf(")");
+	}
+}
+
+/* store to memory operand, value is printed between print_store_begin and print_store_end */
+static void
+print_store_begin(void){
+	switch(classify_access()){
+		case ACCESS_PROMOTED:
+			printf("\t zp_%x = ", parameter);
+			break;
+		case ACCESS_RAM:
+			printf("\t m[%d] = ", get_region_index(parameter));
+			break;
+		case ACCESS_RRIOT_RAM:
+			printf("\t rriot_ram[%d] = ", get_region_index(parameter));
+			break;
+		case ACCESS_IO:
+			printf("\t write_io(");
+			break;
+		default:
+			printf("\t write8(");
+			if(toSet == DYNAMIC){
+				call_corresponding_addressingMode(m[pc]);
+			}else{
+				printf("%d", parameter);
+			}
+			printf(", ");
+	}
+}
+
+static void
+print_store_end(void){
+	int access = classify_access();
+	if((access == ACCESS_IO) || (access == ACCESS_MEMORY)){
+		printf(");\n");
+	}else{
+		printf(";\n");
+	}
+}
+
+/* cycles added by branches and jumps, the translator carries cycles into successors (-O 1), so they may be 0 */
+static void
+print_cycles(const char *format, int value){
+	if(value != 0){
+		printf(format, value);
+	}
+}
+
+/* cycles added by the translator (before I/O, at RTS, on fall through edges ...) */
+static void
+print_add_cycles(int value){
+	print_cycles("\t cycles += %d;\n", value);
 }
 
 /* print surounding code */
-uint16_t
-get_min_rom(void){
-        uint16_t min = 0xffff;
-        for(int i = 0; i < rom_addr; i++){
-                if(rom_addresses[i] < min){
-                        min = rom_addresses[i];
-                }
-        }
-        return min;
+/* first and last address of page read by indexed addressing (ATTR_ROM_DATA or ATTR_RRIOT_DATA), 0 if there is none */
+static int
+get_rom_range(int page, uint8_t attribute, uint16_t *first, uint16_t *last){
+	int found = 0;
+	for(int i = page << 8; i < ((page + 1) << 8); i++){
+		if(address_attributes[i] & attribute){
+			if(!found){
+				*first = i;
+				found = 1;
+			}
+			*last = i;
+		}
+	}
+	return found;
 }
 
-uint16_t
-get_max_rom(void){
-        uint16_t max = 0x0;
-        for(int i = 0; i < rom_addr; i++){
-                if(rom_addresses[i] > max){
-                        max = rom_addresses[i];
-                }
-        }
-        return max;
+/* first and last address of a kind of region in the memory map */
+static int
+get_region_bounds(uint8_t kind, uint16_t *first, uint16_t *last){
+	int found = 0;
+	for(int i = 0; i <= 0xffff; i++){
+		if(get_memory_region(i) == kind){
+			if(!found){
+				*first = i;
+				found = 1;
+			}
+			*last = i;
+		}
+	}
+	return found;
 }
 
-uint16_t
-get_min_rriot(void){
-        uint16_t min = 0xffff;
-        for(int i = 0; i < rriot_addr; i++){
-                if(rriot_rom[i] < min){
-                        min = rriot_rom[i];
-                }
-        }
-        return min;
+/* RAM (m) and RRIOT RAM (rriot_ram) of generated code hold the addresses of their regions in address order */
+static int
+get_array_size(uint8_t kind){
+	int size = get_region_size(kind);
+	return (size > 0) ? size : 1;
 }
 
-uint16_t
-get_max_rriot(void){
-        uint16_t max = 0x0;
-        for(int i = 0; i < rriot_addr; i++){
-                if(rriot_rom[i] > max){
-                        max = rriot_rom[i];
-                }
-        }
-        return max;
+static int
+has_rom_table(uint8_t attribute){
+	uint16_t first;
+	uint16_t last;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* ROM read by indexed addressing as table in flash, ranges of all pages are packed in ascending order (see print_page_table) */
+static void
+print_rom_table(const char *name, uint8_t attribute){
+	uint16_t first;
+	uint16_t last;
+	int size = 0;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			size += last - first + 1;
+		}
+	}
+	printf("const uint8_t %s[%d] PROGMEM = {", name, size);
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, attribute, &first, &last)){
+			for(int i = first; i <= last; i++){
+				size--;
+				printf((size > 0) ? "%d, " : "%d};\n", m[i]);
+			}
+		}
+	}
 }
 
 
-void
+static void
 print_set_up_timer(void){
         printf("void\nset_up_timer(uint32_t start){\n");
         printf("\t TCCR1A = 0;\n");
-        printf("\t TCCR1B |= (1 << CS10);\n");
-	printf("\t TIMSK1 |= (1 << TOIE1);\n");
+	//prescaler 8: Timer1 counts TICKS_PER_CYCLE ticks for every 6502 cycle
+        printf("\t TCCR1B = (1 << CS11);\n");
+	printf("\t TIMSK1 = (1 << TOIE1);\n");
         printf("\t TCNT1 = start;\n");
-	printf("\t overflow = 0;\n");
-	printf("\t io = 0;\n");
+	printf("\t epoch = 0;\n");
+	printf("\t deadline = start;\n");
+	printf("\t set_sleep_mode(SLEEP_MODE_IDLE);\n");
         printf("}\n\n");
 }
 
-void
+static void
 print_calculate_time_cycles(void){
         printf("uint16_t\ncalculate_time(uint32_t counter){\n");
         printf("\t return (uint16_t) counter/16;\n");
         printf("}\n\n");
 }
 
-void
+static void
 print_prolog(void){
         printf("#include <stdint.h>\n");
         printf("#include <avr/io.h>\n");
         printf("#include <avr/interrupt.h>\n");
+        printf("#include <avr/pgmspace.h>\n");
+        printf("#include <avr/sleep.h>\n");
         printf("#include \"serialCom.h\"\n\n");
 
-	printf("#define OUTPUT_MIN 0x8b00\n");
-        printf("#define OUTPUT_MAX 0x8b7f\n\n");
-
-	printf("#define RAM_MIN 0x0000\n");
-        printf("#define RAM_MAX 0x01ff\n\n");
+	//16 MHz AVR, 1 MHz 6502, Timer1 prescaler 8
+	printf("#define TICKS_PER_CYCLE 2\n");
+	if(output_queue > 0){
+		printf("#define OUTPUT_QUEUE_SIZE %d\n", output_queue);
+		printf("#define OUTPUT_QUEUE_MASK (OUTPUT_QUEUE_SIZE - 1)\n");
+		//release_output tries again after 128 us if the transmit queue of serialCom.c is full
+		printf("#define OUTPUT_RETRY_TICKS 256\n");
+	}
+	uint16_t first;
+	uint16_t last;
+	if(get_region_bounds(REGION_IO, &first, &last)){
+		printf("#define OUTPUT_MIN 0x%04x\n", first);
+		printf("#define OUTPUT_MAX 0x%04x\n\n", last);
+	}
+	if(get_region_bounds(REGION_RAM, &first, &last)){
+		printf("#define RAM_MIN 0x%04x\n", first);
+		printf("#define RAM_MAX 0x%04x\n\n", last);
+	}
 
-	if(rom_addr > 0){
-                printf("#define ROM_MIN %d\n", get_min_rom());
-        }
-        if(rriot_addr > 0){
-                printf("#define RRIOT_MIN %d\n", get_min_rriot());
-        }
-        printf("\n");
 }
 
-void
+static void
 print_jump_table_jsr(void){
 	if(jsr_counter > 0){
 		printf("\t uint16_t address = 0;\n");
@@ -236,7 +376,7 @@ print_jump_table_jsr(void){
 	}
 }
 
-void
+static void
 print_global_vars_and_functions(void){
         if(optimization){
 		if(usedRegisters & (1 << RA)){
@@ -258,40 +398,52 @@ print_global_vars_and_functions(void){
 		printf("uint8_t rs;\n\n");
 	}
 
-        printf("volatile uint8_t wait;\n");
-        printf("volatile uint8_t ioValue;\n\n");
-        printf("volatile uint16_t overflow;\n");
-	printf("volatile uint8_t io;\n");
+	//Timer1 overflows and time of last output (see write_io)
+	printf("volatile uint16_t epoch;\n");
+	printf("uint32_t deadline;\n");
 
 	printf("uint8_t flags;\n");
+	//flags are evaluated lazily: N is bit 7 of flag_n, Z is set if flag_z is 0,
+	//C is flag_c (0 or 1) and V is set if flag_v is not 0, flags holds I, D and B
+	printf("uint8_t flag_n;\n");
+	printf("uint8_t flag_z;\n");
+	printf("uint8_t flag_c;\n");
+	printf("uint8_t flag_v;\n");
         printf("uint32_t cycles;\n");
-        printf("uint8_t m[512];\n");
-	printf("uint8_t rriot_ram[64];\n\n");
-
-        if(rom_addr > 0){
-                printf("uint16_t rom[%d] = {", rom_addr);
-                uint16_t end = get_max_rom();
-                for(int i = get_min_rom(); i < end; i++){
-                        printf("%d, ", m[i]);
-                }
-                printf("%d};\n", m[end]);
-        }
-        if(rriot_addr > 0){
-                printf("uint16_t rriot_rom[%d] = {", rriot_addr);
-                uint16_t end = get_max_rriot();
-                for(int i = get_min_rriot(); i < end; i++){
-                        printf("%d, ", m[i]);
-                }
-                printf("%d};\n", m[end]);
-        }
+        printf("uint8_t m[%d];\n", get_array_size(REGION_RAM));
+	printf("uint8_t rriot_ram[%d];\n\n", get_array_size(REGION_RRIOT_RAM));
+	if(optimization){
+		uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+		int count = get_promoted_zero_page(promoted);
+		for(int i = 0; i < count; i++){
+			printf("register uint8_t zp_%x asm (\"r%d\");\n", promoted[i], PROMOTED_REGISTER + i);
+		}
+		if(count > 0){
+			printf("\n");
+		}
+	}
+
+	if(has_rom_table(ATTR_ROM_DATA)){
+		print_rom_table("rom", ATTR_ROM_DATA);
+	}
+	if(has_rom_table(ATTR_RRIOT_DATA)){
+		print_rom_table("rriot_rom", ATTR_RRIOT_DATA);
+	}
         printf("\n");
 
+	//subroutines translated to functions may call each other
+	for(int i = 0; i < 65536; i++){
+		if((get_function(i) == i) && !is_inlined(i)){
+			printf("void sub_%x(void);\n", i);
+		}
+	}
+
         print_set_up_timer();
         print_calculate_time_cycles();
 }
 
 
-void
+static void
 print_main(void){
         printf("int main(void){\n");
 	print_jump_table_jsr();
@@ -302,6 +454,10 @@ print_main(void){
 	}
         printf("\t cycles = 0;\n");
 	printf("\t flags = 0;\n");
+	printf("\t flag_n = 0;\n");
+	printf("\t flag_z = 1;\n");
+	printf("\t flag_c = 0;\n");
+	printf("\t flag_v = 0;\n");
 	if(optimization){
 		if(usedRegisters & (1 << RA)){
         		printf("\t ra = 0;\n");
@@ -315,6 +471,11 @@ print_main(void){
 		if(usedRegisters & (1 << RS)){
         		printf("\t rs = 0xfd;\n");
 		}
+		uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+		int count = get_promoted_zero_page(promoted);
+		for(int i = 0; i < count; i++){
+			printf("\t zp_%x = 0;\n", promoted[i]);
+		}
 	}else{
 		printf("\t ra = 0;\n");
 		printf("\t rx = 0;\n");
@@ -323,111 +484,115 @@ print_main(void){
 	}
 }
 
-void
+static void
+print_function_prolog(uint16_t entry){
+	printf("void\nsub_%x(void){\n", entry);
+	if(usedRegisters & (1 << TEMP)){
+		printf("\t uint16_t temp = 0;\n");
+	}
+}
+
+static void
+print_function_epilog(void){
+	printf("}\n\n");
+}
+
+static void
 print_epilog(void){
         printf("}\n\n");
 
 	printf("ISR(TIMER1_OVF_vect){\n");
-	printf("\t if(io && (overflow == 0)){\n");
-        printf("\t\t putChar(ioValue);\n");
-        printf("\t\t putChar('\\n');\n");
-        printf("\t\t wait = 0;\n");
-        printf("\t }else if((io && (overflow != 0))){\n");
-        printf("\t\t overflow--;\n");
-        printf("\t }else{\n");
-        printf("\t\t overflow++;\n");
-        printf("\t }\n");
-	printf("}");
+	printf("\t epoch++;\n");
+	printf("}\n\n");
+	if(output_queue == 0){
+		//only wakes write_io
+		printf("EMPTY_INTERRUPT(TIMER1_COMPA_vect);\n");
+	}
 }
 
 
+/* collapsed delay loop (see collapse_delay_loops): only its cycles and the state it leaves are printed */
+static void
+print_delay_loop(uint32_t cycles, int x, int y, int result){
+	printf("\t cycles += %lu;\n", (unsigned long) cycles);
+	if(x != -1){
+		printf("\t rx = %d;\n", x);
+	}
+	if(y != -1){
+		printf("\t ry = %d;\n", y);
+	}
+	if(result != -1){
+		printf("\t flag_z = %d;\n", result);
+		printf("\t flag_n = %d;\n", result);
+	}
+}
+
 /* Code for printing flags */
 
-void
-code_for_NF_flag(int reg){
+static const char*
+name_of_register(int reg){
 	if(reg == RA){
-		fprintf(stdout, "\t setflag(%d, ((ra & 0x80) > 0));\n", NF);
+		return "ra";
 	}else if(reg == RX){
-		fprintf(stdout, "\t setflag(%d, ((rx & 0x80) > 0));\n", NF);
+		return "rx";
 	}else if(reg == RY){
-		fprintf(stdout, "\t setflag(%d, ((ry & 0x80) > 0));\n", NF);
+		return "ry";
 	}
+	//result of ADC, SBC and compare instructions
+	return "(uint8_t) temp";
 }
 
-void
-code_for_set_VF_ADC_SBC(uint16_t parameter){
-	printf("\t setflag(%d, ((((temp & 0xFF) ^ ra) & ((temp & 0xFF) ^ %d) & 0x80) > 0));\n", VF, parameter);
+static void
+code_for_NF_flag(int reg){
+	printf("\t flag_n = %s;\n", name_of_register(reg));
 }
 
-void
-code_for_set_VF_ADC_SBC_dynamic(char *value, char *parameter){
-        printf("setflag(VF, ((((%s & 0xFF) ^ ra) & ((%s & 0xFF) ^ %s) & 0x80) > 0)));\n", value, value, parameter);
+static void
+code_for_set_VF_ADC_SBC(uint16_t parameter){
+	printf("\t flag_v = ((temp & 0xFF) ^ ra) & ((temp & 0xFF) ^ %d) & 0x80;\n", parameter);
 }
 
-void
+static void
 code_for_ZF_flag(int reg){
-	if(reg == RA){
-		fprintf(stdout, "\t setflag(%d, (ra == 0x00));\n", ZF);
-	}else if(reg == RX){
-		fprintf(stdout, "\t setflag(%d, (rx == 0x00));\n", ZF);
-	}else if(reg == RY){
-		fprintf(stdout, "\t setflag(%d, (ry == 0x00));\n", ZF);
-	}
+	printf("\t flag_z = %s;\n", name_of_register(reg));
 }
 
-void
+static void
 code_for_CF_flag(void){
-	fprintf(stdout, "\t setflag(%d, (temp > 0xFF));\n", CF); 
+	//temp holds at most 0x1FF
+	printf("\t flag_c = temp >> 8;\n");
 }
 
-void
-code_for_CF_flag_dynamic(char *value){
-	fprintf(stdout, "\t setflag(%d, ((%s > 0xFF));\n", CF, value);
-}
-
-void
+static void
 code_for_ZF_dynamic(uint8_t toSet){
-	printf("\t setflag(%d, ", ZF);
+	printf("\t flag_z = ");
         if(toSet == DYNAMIC){
-        	printf("read8(");
-                call_corresponding_addressingMode(m[pc]);
-                printf(")");
+        	print_read8();
         }else{
                 printf("%d", m[parameter]);
         }
-        printf(" > 0);\n");
+        printf(";\n");
 }
 
-void
+static void
 code_for_NF_dynamic(uint8_t toSet){
-	printf("\t setflag(%d, ", NF);
+	printf("\t flag_n = ");
         if(toSet == DYNAMIC){
-        	printf("read8(");
-                call_corresponding_addressingMode(m[pc]);
-                printf(")");
+        	print_read8();
         }else{
                 printf("%d", m[parameter]);
 	}
-        printf(" & 0x80);\n");
+        printf(";\n");
 }
 
-void
+static void
 set_CF_for_Compare(void){
-	printf("\t setflag(0, ra >= ");
-        if(toSet == DYNAMIC){
-	        printf("read8(");
-                call_corresponding_addressingMode(m[pc]);
-                printf("));\n");
-	}else if(code[m[pc]].addressingMode == 0x9){
-		//immediate addressing
-		printf("%d);\n", parameter);
-	}else{
-                printf("%d);\n", m[parameter]);
-        }
+	//temp = register - operand, no borrow if it did not wrap around
+	printf("\t flag_c = temp < 0x100;\n");
 }
 
 /* possible Helper Functions for Programm Execution */
-void
+static void
 convert_number_to_bcd(void){
 	printf("int\nconvert_number_to_bcd(int number){\n");
 	printf("\t int bcd_number = 0;\n");
@@ -442,7 +607,7 @@ convert_number_to_bcd(void){
 	printf("}");
 }
 
-void
+static void
 convert_bcd_to_number(void){
 	printf("int\nconvert_bcd_to_number(int bcd_number){\n");
 	printf("\t int number = 0;\n");
@@ -460,97 +625,376 @@ convert_bcd_to_number(void){
 	printf("}");
 }
 
-void
-add(void){
-	printf("int\nadd(uint8_t number, uint8_t add_term){\n");
-	printf("\t if((flags & (1 << %d)) > 0){\n", DF);
-        printf("\t\t number = convert_bcd_to_number(number);\n");
-        printf("\t\t number += convert_bcd_to_number(add_term);\n");
-        printf("\t\t return convert_number_to_bcd(number);\n");
-        printf("\t }else{\n");
-        printf("\t\t return number + add_term;\n");
-        printf("\t }\n");
+static void
+get_flags(void){
+	printf("uint8_t\nget_flags(void){\n");
+	printf("\t uint8_t value = flags & ~((1 << %d) | (1 << %d) | (1 << %d) | (1 << %d));\n", NF, VF, ZF, CF);
+	printf("\t value |= flag_n & 0x80;\n");
+	printf("\t if(flag_v){\n");
+	printf("\t\t value |= (1 << %d);\n", VF);
+	printf("\t }\n");
+	printf("\t if(flag_z == 0){\n");
+	printf("\t\t value |= (1 << %d);\n", ZF);
+	printf("\t }\n");
+	printf("\t return value | flag_c;\n");
 	printf("}");
 }
 
-void
-sub(void){
-        printf("int\nsub(uint8_t number, uint8_t add_term){\n");
-	printf("\t if((flags & (1 << %d)) > 0){\n", DF);
-        printf("\t\t number = convert_bcd_to_number(number);\n");
-        printf("\t\t number -= convert_bcd_to_number(add_term);\n");
-        printf("\t\t return convert_number_to_bcd(number);\n");
-        printf("\t }else{\n");
-        printf("\t\t return number - add_term;\n");
-        printf("\t }\n");
-        printf("}");
+static void
+set_flags(void){
+	printf("void\nset_flags(uint8_t value){\n");
+	printf("\t flags = value;\n");
+	printf("\t flag_n = value;\n");
+	printf("\t flag_z = (value & (1 << %d)) == 0;\n", ZF);
+	printf("\t flag_c = value & (1 << %d);\n", CF);
+	printf("\t flag_v = value & (1 << %d);\n", VF);
+	printf("}");
 }
 
-void
-setflag(void){
-	printf("void\nsetflag(int flag, uint8_t value){\n");
-        printf("\t if(value == 0){\n");
-        printf("\t\t flags &= ~(1 << flag);\n");
-        printf("\t }else{\n");
-        printf("\t\t flags |= (1 << flag);\n");
-        printf("\t }\n");
-	printf("}");
+/* page table of generated code: kind of every 6502 page and index of its first byte in the array
+ * representing the page, read8 and write8 need one lookup for every address. A page holding more
+ * than one kind of region of the memory map is PAGE_MIXED, its regions are tested by address */
+enum{PAGE_NONE, PAGE_RAM, PAGE_RRIOT, PAGE_IO, PAGE_MIXED, PAGE_ROM, PAGE_RRIOT_ROM};
+
+static int
+get_page_kind(int page){
+	int count[REGION_DATA + 1] = {0};
+	for(int i = page << 8; i < ((page + 1) << 8); i++){
+		count[get_memory_region(i)]++;
+	}
+	if(count[REGION_RAM] == 256){
+		return PAGE_RAM;
+	}else if(count[REGION_RRIOT_RAM] == 256){
+		return PAGE_RRIOT;
+	}else if(count[REGION_IO] == 256){
+		return PAGE_IO;
+	}else if(count[REGION_RAM] + count[REGION_RRIOT_RAM] + count[REGION_IO] > 0){
+		return PAGE_MIXED;
+	}
+	return PAGE_NONE;
 }
 
-void
+static void
+print_page_table(void){
+	uint8_t kind[256] = {PAGE_NONE};
+	uint16_t base[256] = {0};
+
+	for(int page = 0; page < 256; page++){
+		kind[page] = get_page_kind(page);
+		if((kind[page] == PAGE_RAM) || (kind[page] == PAGE_RRIOT)){
+			base[page] = get_region_index(page << 8);
+		}
+	}
+	//index into ROM tables is offset of range of page minus its first address in page (modulo 2^16)
+	uint16_t first;
+	uint16_t last;
+	uint16_t rom_offset = 0;
+	uint16_t rriot_offset = 0;
+	for(int page = 0; page < 256; page++){
+		if(get_rom_range(page, ATTR_ROM_DATA, &first, &last)){
+			kind[page] = (kind[page] == PAGE_MIXED) ? PAGE_MIXED : PAGE_ROM;
+			base[page] = rom_offset - (first & 0xff);
+			rom_offset += last - first + 1;
+		}else if(get_rom_range(page, ATTR_RRIOT_DATA, &first, &last)){
+			kind[page] = (kind[page] == PAGE_MIXED) ? PAGE_MIXED : PAGE_RRIOT_ROM;
+			base[page] = rriot_offset - (first & 0xff);
+			rriot_offset += last - first + 1;
+		}
+	}
+
+	printf("#define PAGE_NONE %d\n", PAGE_NONE);
+	printf("#define PAGE_RAM %d\n", PAGE_RAM);
+	printf("#define PAGE_RRIOT %d\n", PAGE_RRIOT);
+	printf("#define PAGE_IO %d\n", PAGE_IO);
+	printf("#define PAGE_MIXED %d\n", PAGE_MIXED);
+	printf("#define PAGE_ROM %d\n", PAGE_ROM);
+	printf("#define PAGE_RRIOT_ROM %d\n\n", PAGE_RRIOT_ROM);
+	printf("const uint8_t page_kind[256] PROGMEM = {");
+	for(int page = 0; page < 256; page++){
+		printf((page < 255) ? "%d, " : "%d};\n", kind[page]);
+	}
+	printf("const uint16_t page_base[256] PROGMEM = {");
+	for(int page = 0; page < 256; page++){
+		printf((page < 255) ? "%d, " : "%d};\n\n", base[page]);
+	}
+}
+
+/* access of read8 (write == 0) or write8 to RAM, RRIOT RAM or I/O of region start ... end of a PAGE_MIXED page */
+static void
+print_mixed_region(const char *address, int write, uint8_t region, uint16_t start, uint16_t end){
+	if((region != REGION_RAM) && (region != REGION_RRIOT_RAM) && (region != REGION_IO)){
+		return;
+	}
+	printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, start, address, end);
+	//index in array is address minus number of addresses of other kinds below it
+	const char *array = (region == REGION_RAM) ? "m" : "rriot_ram";
+	int offset = start - get_region_index(start);
+	if(write){
+		if(region == REGION_IO){
+			printf("\t\t\t\t write_io(value);\n");
+		}else{
+			printf("\t\t\t\t %s[%s - 0x%04x] = value;\n", array, address, offset);
+		}
+		printf("\t\t\t\t return;\n");
+	}else if(region == REGION_IO){
+		if(output_queue > 0){
+			printf("\t\t\t\t sync_io();\n");
+		}
+		printf("\t\t\t\t return 0;\n");
+	}else{
+		printf("\t\t\t\t return %s[%s - 0x%04x];\n", array, address, offset);
+	}
+	printf("\t\t\t }\n");
+}
+
+static void
+print_mixed_pages(const char *address, int write){
+	uint16_t first;
+	uint16_t last;
+	for(int page = 0; page < 256; page++){
+		if(get_page_kind(page) != PAGE_MIXED){
+			continue;
+		}
+		//regions in page
+		int start = page << 8;
+		while(start < ((page + 1) << 8)){
+			uint8_t region = get_memory_region(start);
+			int end = start;
+			while((end + 1 < ((page + 1) << 8)) && (get_memory_region(end + 1) == region)){
+				end++;
+			}
+			print_mixed_region(address, write, region, start, end);
+			start = end + 1;
+		}
+		//ROM read by indexed addressing, see print_page_table
+		if(write){
+			continue;
+		}else if(get_rom_range(page, ATTR_ROM_DATA, &first, &last)){
+			printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, first, address, last);
+			printf("\t\t\t\t return pgm_read_byte(&rom[index]);\n");
+			printf("\t\t\t }\n");
+		}else if(get_rom_range(page, ATTR_RRIOT_DATA, &first, &last)){
+			printf("\t\t\t if((%s >= 0x%04x) && (%s <= 0x%04x)){\n", address, first, address, last);
+			printf("\t\t\t\t return pgm_read_byte(&rriot_rom[index]);\n");
+			printf("\t\t\t }\n");
+		}
+	}
+	printf("\t\t\t break;\n");
+}
+
+/* timer and synchronisation with 6502 time used by write8 and read8 */
+static void
+print_synchronisation(void){
+	//time of Timer1 extended by epoch (overflows), called with interrupts disabled
+	printf("uint32_t\ntimer_ticks(void){\n");
+	printf("\t uint16_t low = TCNT1;\n");
+	printf("\t uint16_t high = epoch;\n");
+	printf("\t if((TIFR1 & (1 << TOV1)) && (low < 0x8000)){\n");
+	printf("\t\t high++;\n");
+	printf("\t }\n");
+	printf("\t return ((uint32_t) high << 16) | low;\n");
+	printf("}\n");
+
+	if(output_queue == 0){
+		//synchronisation of AVR with 6502 before output: the output is due cycles 6502 cycles after the last one,
+		//the CPU sleeps until the compare match of OCR1A (and the overflows before it) wakes it
+		printf("void\nwrite_io(uint8_t value){\n");
+		printf("\t uint8_t sreg = SREG;\n");
+		printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+		printf("\t cycles = 0;\n");
+		printf("\t OCR1A = (uint16_t) deadline;\n");
+		printf("\t TIFR1 = (1 << OCF1A);\n");
+		printf("\t TIMSK1 |= (1 << OCIE1A);\n");
+		printf("\t cli();\n");
+		printf("\t while((int32_t) (deadline - timer_ticks()) > 0){\n");
+		printf("\t\t sleep_enable();\n");
+		printf("\t\t sei();\n");
+		printf("\t\t sleep_cpu();\n");
+		printf("\t\t sleep_disable();\n");
+		printf("\t\t cli();\n");
+		printf("\t }\n");
+		printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+		printf("\t SREG = sreg;\n");
+		printf("\t putChar(value);\n");
+		printf("\t putChar('\\n');\n");
+		printf("}\n\n");
+		return;
+	}
+
+	//run-ahead: outputs wait in queue with the time they are due, release_output prints them in the
+	//compare match ISR of OCR1A while the program goes on, it only waits if the queue is full
+	printf("uint32_t queue_time[OUTPUT_QUEUE_SIZE];\n");
+	printf("uint8_t queue_value[OUTPUT_QUEUE_SIZE];\n");
+	printf("volatile uint8_t queue_head;\n");
+	printf("volatile uint8_t queue_tail;\n\n");
+
+	//called with interrupts disabled, OCIE1A is enabled as long as the queue is not empty
+	printf("void\nrelease_output(void){\n");
+	printf("\t while(queue_tail != queue_head){\n");
+	printf("\t\t uint8_t tail = queue_tail;\n");
+	printf("\t\t OCR1A = (uint16_t) queue_time[tail];\n");
+	printf("\t\t TIMSK1 |= (1 << OCIE1A);\n");
+	printf("\t\t if((int32_t) (queue_time[tail] - timer_ticks()) > 0){\n");
+	printf("\t\t\t return;\n");
+	printf("\t\t }\n");
+	//putChar would drop characters with interrupts disabled: value and newline stay queued until they fit
+	printf("\t\t if(txFree() < 2){\n");
+	printf("\t\t\t OCR1A = TCNT1 + OUTPUT_RETRY_TICKS;\n");
+	printf("\t\t\t return;\n");
+	printf("\t\t }\n");
+	printf("\t\t putChar(queue_value[tail]);\n");
+	printf("\t\t putChar('\\n');\n");
+	printf("\t\t queue_tail = (tail + 1) & OUTPUT_QUEUE_MASK;\n");
+	printf("\t }\n");
+	printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+	printf("}\n\n");
+
+	printf("ISR(TIMER1_COMPA_vect){\n");
+	printf("\t release_output();\n");
+	printf("}\n\n");
+
+	printf("void\nwrite_io(uint8_t value){\n");
+	printf("\t uint8_t sreg = SREG;\n");
+	printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+	printf("\t cycles = 0;\n");
+	printf("\t uint8_t head = queue_head;\n");
+	printf("\t uint8_t next = (head + 1) & OUTPUT_QUEUE_MASK;\n");
+	printf("\t cli();\n");
+	printf("\t while(next == queue_tail){\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t queue_time[head] = deadline;\n");
+	printf("\t queue_value[head] = value;\n");
+	printf("\t queue_head = next;\n");
+	printf("\t release_output();\n");
+	printf("\t SREG = sreg;\n");
+	printf("}\n\n");
+
+	//input is read at its time: the outputs before it are released, then the CPU sleeps until it is due
+	printf("void\nsync_io(void){\n");
+	printf("\t uint8_t sreg = SREG;\n");
+	printf("\t deadline += (uint32_t) cycles * TICKS_PER_CYCLE;\n");
+	printf("\t cycles = 0;\n");
+	printf("\t cli();\n");
+	printf("\t while(queue_tail != queue_head){\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t OCR1A = (uint16_t) deadline;\n");
+	printf("\t TIFR1 = (1 << OCF1A);\n");
+	printf("\t while((int32_t) (deadline - timer_ticks()) > 0){\n");
+	printf("\t\t TIMSK1 |= (1 << OCIE1A);\n");
+	printf("\t\t sleep_enable();\n");
+	printf("\t\t sei();\n");
+	printf("\t\t sleep_cpu();\n");
+	printf("\t\t sleep_disable();\n");
+	printf("\t\t cli();\n");
+	printf("\t }\n");
+	printf("\t TIMSK1 &= ~(1 << OCIE1A);\n");
+	printf("\t SREG = sreg;\n");
+	printf("}\n\n");
+
+	//runs when main returns, before exit disables interrupts and before USART_Flush of serialCom.c
+	printf("__attribute__((destructor)) void\nflush_output(void){\n");
+	printf("\t while((SREG & (1 << SREG_I)) && (queue_tail != queue_head));\n");
+	printf("}\n\n");
+}
+
+static void
 write8(void){
-        printf("void\nwrite8(uint16_t address, uint8_t value){\n");
-	printf("\t if((address >= OUTPUT_MIN) && (address <= OUTPUT_MAX)){\n");
-        printf("\t\t uint32_t avrCycles = ((uint32_t) overflow << 16) | TCNT1;\n");
-        printf("\t\t TCNT1 = 0;\n");
-        printf("\t\t uint32_t time = (cycles * 16) - avrCycles;\n");
-        printf("\t\t overflow = time >> 16;\n");
-	printf("\t\t time = 0xffff - (time & 0xffff);\n");
-        printf("\t\t ioValue = value;\n");
-	printf("\t\t io = 1;\n");
-        printf("\t\t wait = 1;\n");
-	printf("\t\t TCNT1 += time;\n");
-        printf("\t\t while(wait);\n");
-        printf("\t\t TCNT1 = 0;\n");
-        printf("\t\t cycles = 0;\n");
-	printf("\t\t overflow = 0;\n");
-	printf("\t\t io = 0;\n");
-        printf("\t }else if((address >= RAM_MIN) && (address <= RAM_MAX)){\n");
-        printf("\t\t m[address] = value;\n");
-        printf("\t }\n");
-        printf("}\n");
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+
+	printf("void\nwrite8%s(uint16_t address, uint8_t value){\n", (count > 0) ? "_memory" : "");
+	printf("\t uint8_t page = address >> 8;\n");
+	printf("\t switch(pgm_read_byte(&page_kind[page])){\n");
+	printf("\t\t case PAGE_RAM:\n");
+	printf("\t\t\t m[pgm_read_word(&page_base[page]) + (address & 0xff)] = value;\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_RRIOT:\n");
+	printf("\t\t\t rriot_ram[pgm_read_word(&page_base[page]) + (address & 0xff)] = value;\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_IO:\n");
+	printf("\t\t\t write_io(value);\n");
+	printf("\t\t\t break;\n");
+	printf("\t\t case PAGE_MIXED:\n");
+	print_mixed_pages("address", 1);
+	printf("\t }\n");
+	printf("}\n");
+	if(count > 0){
+		printf("static inline __attribute__((always_inline)) void\nwrite8(uint16_t address, uint8_t value){\n");
+		for(int i = 0; i < count; i++){
+			printf("\t if(address == %d){\n", promoted[i]);
+			printf("\t\t zp_%x = value;\n", promoted[i]);
+			printf("\t\t return;\n");
+			printf("\t }\n");
+		}
+		printf("\t write8_memory(address, value);\n");
+		printf("}\n");
+	}
 }
 
-void
+static void
 read8(void){
-	printf("uint8_t\nread8(uint16_t addr){\n");
-        //m represents RAM
-        printf("\t if((addr >= RAM_MIN) && (addr <= RAM_MAX)){\n");
-        printf("\t\t return m[addr];\n");
-        printf("\t }else if((addr >= %d) && (addr <= %d)){\n", RRIOT_RAM_START, RRIOT_ROM_START);
-        printf("\t\t return rriot_ram[addr ^ %d];\n", RRIOT_RAM_START);
-        if(rom_addr > 0){
-                printf("\t }else if((addr >= ROM_MIN) && (addr <= %d)){\n", get_max_rom());
-                printf("\t\t return rom[addr ^ ROM_MIN];\n");
-        }
-        if(rriot_addr > 0){
-                printf("\t }else if((addr >= RRIOT_MIN) && (addr <= %d)){\n", get_max_rriot());
-                printf("\t\t return rom[addr ^ RRIOT_MIN];\n");
-        }
-        printf("\t }\n");
-        printf("\t return 0;\n");
-        printf("}\n");
+	uint8_t promoted[MAX_PROMOTED_ZERO_PAGE];
+	int count = optimization ? get_promoted_zero_page(promoted) : 0;
+
+	printf("uint8_t\nread8%s(uint16_t addr){\n", (count > 0) ? "_memory" : "");
+	printf("\t uint8_t page = addr >> 8;\n");
+	printf("\t uint16_t index = pgm_read_word(&page_base[page]) + (addr & 0xff);\n");
+	printf("\t switch(pgm_read_byte(&page_kind[page])){\n");
+	//m represents RAM
+	printf("\t\t case PAGE_RAM:\n");
+	printf("\t\t\t return m[index];\n");
+	printf("\t\t case PAGE_RRIOT:\n");
+	printf("\t\t\t return rriot_ram[index];\n");
+	printf("\t\t case PAGE_IO:\n");
+	if(output_queue > 0){
+		printf("\t\t\t sync_io();\n");
+	}
+	printf("\t\t\t return 0;\n");
+	printf("\t\t case PAGE_MIXED:\n");
+	print_mixed_pages("addr", 0);
+	if(has_rom_table(ATTR_ROM_DATA)){
+		printf("\t\t case PAGE_ROM:\n");
+		printf("\t\t\t return pgm_read_byte(&rom[index]);\n");
+	}
+	if(has_rom_table(ATTR_RRIOT_DATA)){
+		printf("\t\t case PAGE_RRIOT_ROM:\n");
+		printf("\t\t\t return pgm_read_byte(&rriot_rom[index]);\n");
+	}
+	printf("\t }\n");
+	printf("\t return 0;\n");
+	printf("}\n");
+	if(count > 0){
+		//indexed and indirect accesses may reach promoted bytes
+		printf("static inline __attribute__((always_inline)) uint8_t\nread8(uint16_t addr){\n");
+		for(int i = 0; i < count; i++){
+			printf("\t if(addr == %d){\n", promoted[i]);
+			printf("\t\t return zp_%x;\n", promoted[i]);
+			printf("\t }\n");
+		}
+		printf("\t return read8_memory(addr);\n");
+		printf("}\n");
+	}
 }
 
-void
+static void
 pull8(void){
 	printf("uint8_t\npull8(void){\n");
         printf("\t rs++;\n");
-        printf("\t return m[0x0100 + rs];\n");
+        printf("\t return m[%d + rs];\n", get_region_index(0x0100));
 	printf("}\n");
 }
 
-void
+static void
 push8(void){
 	printf("void\npush8(uint8_t value){\n");
         printf("\t write8((0x0100 + rs), value);\n");
@@ -560,11 +1004,10 @@ push8(void){
 
 /* Instructions */
 
-void ADC(void){ //ADC... add memory to accumulator with carry
+static void ADC(void){ //ADC... add memory to accumulator with carry
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF) | (1 << CF);
 		uses = (1 << CF);
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA)|(1 << TEMP);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
@@ -576,29 +1019,25 @@ void ADC(void){ //ADC... add memory to accumulator with carry
                         }else{
 				printf("\t uint16_t temp = add(r[RA],"); 
 				if(toSet == DYNAMIC){
-                                	printf("read8(");
-                                	call_corresponding_addressingMode(m[pc]);
-                                	printf(")");
+                                	print_read8();
                         	}else{
                                 	printf("%d", m[parameter]);
                         	}
-				printf(") + (flags & (1<<%d));\n", CF);
+				printf(") + flag_c;\n");
 			}
 		}else{
 			if(is_absolute_address(m[pc])){
 				printf("\t temp = ra + ");
 				if(toSet == DYNAMIC){
-					printf("read8(");
-                                	call_corresponding_addressingMode(m[pc]);
-                                	printf(")");
+					print_read8();
                                 	toSet = IR;
                         	}else{
 					printf("%d", m[parameter]);
 				}
-				printf(" + (flags & (1<<%d));\n", CF);
+				printf(" + flag_c;\n");
 				
 			}else{
-				printf("\t temp = ra + %d + (flags & (1<<%d));\n", parameter, CF);
+				printf("\t temp = ra + %d + flag_c;\n", parameter);
 			}
 		}
 		if(optimization){
@@ -609,27 +1048,26 @@ void ADC(void){ //ADC... add memory to accumulator with carry
 				code_for_CF_flag();
 			}
 			if(defs & (1 << ZF)){ 
-				code_for_ZF_flag(RA);
+				code_for_ZF_flag(TEMP);
 			}
 			if(defs & (1 << NF)){
-				code_for_NF_flag(RA);
+				code_for_NF_flag(TEMP);
 			}
 		}else{
 			code_for_set_VF_ADC_SBC(parameter);
                 	code_for_CF_flag();
-                	code_for_ZF_flag(RA);
-                	code_for_NF_flag(RA);
+                	code_for_ZF_flag(TEMP);
+                	code_for_NF_flag(TEMP);
 		}
 		printf("\t ra = (uint8_t) temp & 0xFF;\n");
 	}
 }
 
-void AND(void){ //AND Memory with accumulator
+static void AND(void){ //AND Memory with accumulator
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF); 
 		uses = 0;
 		add_used_helper_function(read8);
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
@@ -638,9 +1076,8 @@ void AND(void){ //AND Memory with accumulator
 		if(is_absolute_address(m[pc])){
 			printf("\t ra = ra & "); 
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+				print_read8();
+                                printf(";\n");
                                 toSet = IR;
                         }else{
 				printf("%d;\n", m[parameter]);
@@ -663,7 +1100,7 @@ void AND(void){ //AND Memory with accumulator
 	}
 }
 
-void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
+static void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0; 
@@ -673,7 +1110,6 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
 			add_used_helper_function(read8);
 			usedRegisters = (1 << TEMP);
 		}
-		add_used_helper_function(setflag);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //ASL\n");
@@ -685,38 +1121,39 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
                         }
 			printf("\t temp = (uint16_t) ("); 
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf("))");
+				print_read8();
+                                printf(")");
                         }else{
 				printf("%d)", m[parameter]);
 			}
 			printf(" << 1;\n");
-			printf("\t write8("); 
-			if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(", ");
-                        }else{
-				printf("%d,", parameter); 
-			}
-			printf(" (uint8_t) (temp & 0x00FF));\n");
+			print_store_begin();
+			printf("(uint8_t) (temp & 0x00FF)");
+			print_store_end();
 
 			if(optimization){
+				if(defs & (1 << CF)){
+					code_for_CF_flag();
+				}
 				if(defs & (1 << ZF)){
-                               		code_for_ZF_dynamic(toSet);
+                               		code_for_ZF_flag(TEMP);
                         	}
                         	if(defs & (1 << NF)){
-                                	code_for_NF_dynamic(toSet);
+                                	code_for_NF_flag(TEMP);
                         	}
 			}else{
-				code_for_ZF_dynamic(toSet);
-				code_for_NF_dynamic(toSet);
+				code_for_CF_flag();
+				code_for_ZF_flag(TEMP);
+				code_for_NF_flag(TEMP);
 			}
 
 		}else{
 			printf("\t temp = (uint16_t) %d << 1;\n", parameter);
 			printf("\t ra = (uint8_t) (temp & 0x00FF);\n");
 			if(optimization){
+				if(defs & (1 << CF)){
+					code_for_CF_flag();
+				}
 				if(defs & (1 << ZF)){
 	                        	code_for_ZF_flag(RA);
         	        	}
@@ -724,6 +1161,7 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
                         		code_for_NF_flag(RA);
                 		}
 			}else{
+				code_for_CF_flag();
 				code_for_ZF_flag(RA);
                 		code_for_NF_flag(RA);
 			}
@@ -731,258 +1169,201 @@ void ASL(void){ //Shift Left One Bit (Memory or Accumulator)
 	}
 }
 
-void BCC(void){ //BCC... branch on carry clean (CF == 0)
+static void BCC(void){ //BCC... branch on carry clean (CF == 0)
         if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << CF);
 	}else if(toSet == IR){
 		printf("\t //BCC\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == 0){ ", CF);
-		printf("cycles += %d;", cycles); 
+		printf("\t if(flag_c == 0){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BCS(void){ //BCS... branch on carry set (CF == 1)
+static void BCS(void){ //BCS... branch on carry set (CF == 1)
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << CF);
         }else if(toSet == IR){
 		printf("\t //BCS\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == (1 << %d)){ ", CF, CF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_c){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BEQ(void){ //Branch on result zero (ZF == 1)
+static void BEQ(void){ //Branch on result zero (ZF == 1)
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << ZF);
         }else if(toSet == IR){
 		printf("\t //BEQ\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == (1 << %d)){ ", ZF, ZF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_z == 0){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BIT(void){ //BIT... Test Bits in Memory with accumulator
+static void BIT(void){ //BIT... Test Bits in Memory with accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF);
 		uses = 0;
-		usedRegisters = (1 << RA);
-		add_used_helper_function(setflag);
+		add_used_helper_function(read8);
+		usedRegisters = (1 << RA) | (1 << TEMP);
         }else if(toSet == IR){
 		printf("\t //BIT\n");
 		call_corresponding_addressingMode(m[pc]);
-		if(optimization){
-			if(defs & (1 << ZF)){
-				printf("\t setflag(%d, ((", ZF);
-				if(toSet == DYNAMIC){
-					printf("read8(");
-					call_corresponding_addressingMode(m[pc]);
-					printf(")");
-					toSet = IR;
-				}else{
-					printf(" %d", m[parameter]); 
-				}
-				printf(" & ra) == 0x00));\n");
-			}
-			if(defs & (1 << NF)){
-        			printf("\t setflag(%d, ((", NF);
-			       	if(toSet == DYNAMIC){
-                                        printf("read8(");
-                                        call_corresponding_addressingMode(m[pc]);
-                                        printf(")");
-                                        toSet = IR;
-                                }else{
-					printf("%d", m[parameter]);
-				}
-				printf(" & (1 << 7)) > 0));\n");
-			}
-			if(defs & (1 << VF)){
-        			printf("\t setflag(%d, ((", VF);
-				if(toSet == DYNAMIC){
-					printf("read8(");
-					call_corresponding_addressingMode(m[pc]);
-                                        printf(")");
-                                        toSet = IR;
-				}else{
-					printf("%d",m[parameter]);
-				}
-				printf(" & (1 << VF)) > 0));\n");
-			}
+		//operand is read once, it may be an I/O register
+		printf("\t temp = ");
+		if(toSet == DYNAMIC){
+			print_read8();
+			toSet = IR;
 		}else{
-			printf("\t setflag(%d, ((", ZF); 
-			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
-                                toSet = IR;
-			}else{
-				printf("%d", m[parameter]);
-			}
-			printf(" & ra) == 0x00));\n");
-			printf("\t setflag(%d, ((", NF); 
-			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
-                                toSet = IR;
-			}else{
-				printf("%d", m[parameter]);
-			}
-			printf(" & (1 << 7)) > 0));\n");
-			printf("\t setflag(%d, ((", VF); 
-			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
-                                toSet = IR;
-			}else{
-				printf("%d", m[parameter]);
-			}
-			printf(" & (1 << 6)) > 0));\n");
+			printf("%d", m[parameter]);
+		}
+		printf(";\n");
+		if(!optimization || (defs & (1 << ZF))){
+			printf("\t flag_z = ra & temp;\n");
+		}
+		if(!optimization || (defs & (1 << NF))){
+			printf("\t flag_n = temp;\n");
+		}
+		if(!optimization || (defs & (1 << VF))){
+			printf("\t flag_v = temp & 0x40;\n");
 		}
 	}
 }
 
-void BMI(void){ //BMI... Branch on result Minus (NF == 1)
+static void BMI(void){ //BMI... Branch on result Minus (NF == 1)
 	if(toSet == DEFS){
 		defs = 0;
                 uses = (1 << NF);
         }else if(toSet == IR){
 		printf("\t //BMI\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == (1 << %d)){ ", NF, NF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_n & 0x80){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BNE(void){ //Branch on result not zero (ZF == 0)
+static void BNE(void){ //Branch on result not zero (ZF == 0)
       	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << ZF);
 	}else if(toSet == IR){
 		printf("\t //BNE\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == 0){ ", ZF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_z){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BPL(void){ //BPL... Branch on Result Plus (NF == 0) 
+static void BPL(void){ //BPL... Branch on Result Plus (NF == 0) 
 	if(toSet == DEFS){
 		defs = 0;
 		uses = (1 << NF);
         }else if(toSet == IR){
 		printf("\t //BPL\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == 0){ ", NF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if((flag_n & 0x80) == 0){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BRK(void){ //BRK is a software interrupt
+static void BRK(void){ //BRK is a software interrupt
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << BF)|(1 << XX)|(1 << IF);
-		add_used_helper_function(setflag);
 		//add_used_helper_function(push8);
         }else if(toSet == IR){
 		printf("\t return 0;\n");
 	}
 }
 
-void BVC(void){ //BVC... Branch on Overflow Clear (VF == 0)
+static void BVC(void){ //BVC... Branch on Overflow Clear (VF == 0)
 	if(toSet == DEFS){
 		uses = (1 << VF);
 		defs = 0;
         }else if(toSet == IR){
 		printf("\t //BVC\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == 0){ ", VF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_v == 0){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void BVS(void){ //BVS... Branch on Overflow Set (VF == 1)
+static void BVS(void){ //BVS... Branch on Overflow Set (VF == 1)
 	if(toSet == DEFS){
 		uses = (1 << VF);
 		defs = 0;
         }else if(toSet == IR){
 		printf("\t //BVS\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t if((flags & (1 << %d)) == (1 << %d)){ ", VF, VF);
-		printf("cycles += %d; ", cycles);
+		printf("\t if(flag_v){ ");
+		print_cycles("cycles += %d; ", cycles_taken);
 		printf("goto L%x;}\n", parameter);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
 	}
 }
 
-void CLC(void){ //CLC... clear carry flag
+static void CLC(void){ //CLC... clear carry flag
 	if(toSet == DEFS){
 		defs = (1 << CF);
 		uses = 0;
-		add_used_helper_function(setflag);
 	}else if(toSet == IR){
-        	printf("\t setflag(%d, 0);\n", CF);
+        	printf("\t flag_c = 0;\n");
 	}
 }
 
-void CLD(void){ //CLD... clear decimal mode
+static void CLD(void){ //CLD... clear decimal mode
 	if(toSet == DEFS){
 		defs = (1 << DF);
 		uses = 0;
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
-		printf("\t setflag(%d, 0);\n", DF);
+		printf("\t flags &= ~(1 << %d);\n", DF);
 	}
 }
 
-void CLI(void){ //Clear Interrupt Disable Bit
+static void CLI(void){ //Clear Interrupt Disable Bit
 	if(toSet == DEFS){
 		defs = (1 << IF);
 		uses = 0;
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
-		printf("\t setflag(%d, 0);\n", IF);
+		printf("\t flags &= ~(1 << %d);\n", IF);
 	}
 }
 
-void CLV(void){ //CLV... clear overflow flag
+static void CLV(void){ //CLV... clear overflow flag
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << VF);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
-		printf("\t setflag(%d, 0);\n", VF);
+		printf("\t flag_v = 0;\n");
 	}
 }
 
-void CMP(void){ //CMP... compare memory with accumulator
+static void CMP(void){ //CMP... compare memory with accumulator
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
 	       	uses = 0;
 		if(is_absolute_address(m[pc])){
 			add_used_helper_function(read8);
 		}
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA) | (1 << TEMP);	
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
@@ -991,9 +1372,8 @@ void CMP(void){ //CMP... compare memory with accumulator
 		if(is_absolute_address(m[pc])){
 			printf("\t temp = ra - ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+				print_read8();
+                                printf(";\n");
                         }else{
 				printf("%d;\n", m[parameter]);
 			}
@@ -1006,28 +1386,27 @@ void CMP(void){ //CMP... compare memory with accumulator
 				toSet = IR;
 			}
                 	if(defs & (1 << ZF)){
-				code_for_ZF_flag(RA);
+				code_for_ZF_flag(TEMP);
 			}
 			if(defs & (1 << NF)){
-                		code_for_NF_flag(RA);
+                		code_for_NF_flag(TEMP);
 			}
 		}else{
 			set_CF_for_Compare();
                         toSet = IR;
-			code_for_ZF_flag(RA);
-			code_for_NF_flag(RA);
+			code_for_ZF_flag(TEMP);
+			code_for_NF_flag(TEMP);
 		}
 	}
 }
 
-void CPX(void){ //CPX... compare Memory with Index X
+static void CPX(void){ //CPX... compare Memory with Index X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0;
 		if(is_absolute_address(m[pc])){
                         add_used_helper_function(read8);
                 }
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RX) | (1 << TEMP);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
@@ -1036,9 +1415,8 @@ void CPX(void){ //CPX... compare Memory with Index X
 		if(is_absolute_address(m[pc])){
                         printf("\t temp = rx - ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+				print_read8();
+                                printf(";\n");
                         }else{
 				printf("%d;\n", m[parameter]);
 			}
@@ -1052,30 +1430,29 @@ void CPX(void){ //CPX... compare Memory with Index X
                                 toSet = IR;
                 	}
                 	if(defs & (1 << ZF)){
-                        	code_for_ZF_flag(RX);
+                        	code_for_ZF_flag(TEMP);
                 	}
                 	if(defs & (1 << NF)){
-                        	code_for_NF_flag(RX);
+                        	code_for_NF_flag(TEMP);
                 	}
 		}else{
 			set_CF_for_Compare();
                         toSet = IR;
-                        code_for_ZF_flag(RX);
-                        code_for_NF_flag(RX);
+                        code_for_ZF_flag(TEMP);
+                        code_for_NF_flag(TEMP);
 		}
 
 
 	}
 }
 
-void CPY(void){ //CPY... compare Memory with Index Y
+static void CPY(void){ //CPY... compare Memory with Index Y
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = 0;
 		if(is_absolute_address(m[pc])){
                         add_used_helper_function(read8);
                 }
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RY) | (1 << TEMP);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
@@ -1084,9 +1461,8 @@ void CPY(void){ //CPY... compare Memory with Index Y
 		if(is_absolute_address(m[pc])){
                         printf("\t temp = ry - ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+				print_read8();
+                                printf(";\n");
                         }else{
 				printf("%d;\n", m[parameter]);
 			}
@@ -1099,28 +1475,27 @@ void CPY(void){ //CPY... compare Memory with Index Y
                                 toSet = IR;
                 	}
                 	if(defs & (1 << ZF)){
-                        	code_for_ZF_flag(RY);
+                        	code_for_ZF_flag(TEMP);
                 	}
                 	if(defs & (1 << NF)){
-                        	code_for_NF_flag(RY);
+                        	code_for_NF_flag(TEMP);
                 	}
 		}else{
 			set_CF_for_Compare();
                         toSet = IR;
-                        code_for_ZF_flag(RY);
-                        code_for_NF_flag(RY);
+                        code_for_ZF_flag(TEMP);
+                        code_for_NF_flag(TEMP);
 		}
 
 
 	}
 }
 
-void DEC(void){ //Decrement Memory by one
+static void DEC(void){ //Decrement Memory by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		add_used_helper_function(write8);
-		add_used_helper_function(setflag);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //DEC\n");
@@ -1141,15 +1516,14 @@ void DEC(void){ //Decrement Memory by one
 				printf(", sub(m[%d], 1));", parameter);
 			}
 		}else{
-			printf("\t write8(");
+			print_store_begin();
 			if(toSet == DYNAMIC){
-				call_corresponding_addressingMode(m[pc]);
-                                printf(", read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(") - 1);\n");
+				print_read8();
+				printf(" - 1");
                         }else{
-				printf("%d, %d - 1);\n", parameter, m[parameter]);
+				printf("%d - 1", m[parameter]);
 			}
+			print_store_end();
 		}
 		if(optimization){	
                 	if(defs & (1 << ZF)){
@@ -1168,12 +1542,11 @@ void DEC(void){ //Decrement Memory by one
 	}
 }
 
-void DEX(void){ //Decrement Index X by one
+static void DEX(void){ //Decrement Index X by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RX);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t //DEX\n");
 		if(bcd){
@@ -1196,11 +1569,10 @@ void DEX(void){ //Decrement Index X by one
         }
 }
 
-void DEY(void){ //Decrement Index Y by one
+static void DEY(void){ //Decrement Index Y by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RY);
         }else if(toSet == IR){
 		printf("\t //DEY\n");
@@ -1223,27 +1595,26 @@ void DEY(void){ //Decrement Index Y by one
 	}
 }
 
-void EOR(void){ //Exclusive-OR Memory with Accumulator
+static void EOR(void){ //Exclusive-OR Memory with Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		if(is_absolute_address(m[pc])){
 			add_used_helper_function(read8);
 		}
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //EOR\n");
 		call_corresponding_addressingMode(m[pc]);
 		if(is_absolute_address(m[pc])){
-			printf("\t ra = ra ^ read8(");
+			printf("\t ra = ra ^ ");
 			if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+                                print_read8();
+                                printf(";\n");
                                 toSet = IR;
                         }else{
-				printf("%d);\n", m[parameter]);
+				printf("%d;\n", m[parameter]);
 			}
 		}else{
 			printf("\t ra = ra ^ %d;\n", parameter);
@@ -1263,12 +1634,11 @@ void EOR(void){ //Exclusive-OR Memory with Accumulator
 	}
 }
 
-void INC(void){ //Increment Memory by one
+static void INC(void){ //Increment Memory by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		add_used_helper_function(write8);
-		add_used_helper_function(setflag);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //INC\n");
@@ -1281,21 +1651,21 @@ void INC(void){ //Increment Memory by one
 			printf("\t write8(parameter, ");
 			if(toSet == DYNAMIC){
 				call_corresponding_addressingMode(m[pc]);
-                                printf(", add(read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(")");
+                                printf(", add(");
+				print_read8();
 			}else{
 				printf("%d, add(m[%d]", parameter, parameter);
 			}
 			printf(", 1));\n");
 		}else{
-			printf("\t write8(");
+			print_store_begin();
 		       	if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                          	printf(", read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(") + 1);\n");
-                        }
+				print_read8();
+				printf(" + 1");
+                        }else{
+				printf("%d + 1", m[parameter]);
+			}
+			print_store_end();
 		}
 		if(optimization){
 			if(defs & (1 << ZF)){
@@ -1314,12 +1684,11 @@ void INC(void){ //Increment Memory by one
 	}
 }
 
-void INX(void){ //Increment Index X by one
+static void INX(void){ //Increment Index X by one
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
 		usedRegisters = (1 << RX);
-		add_used_helper_function(setflag);
 	}else if(toSet == IR){
 		printf("\t //INX\n");
 		if(bcd){
@@ -1342,12 +1711,11 @@ void INX(void){ //Increment Index X by one
 	}
 }
 
-void INY(void){ //Increment Index Y by one
+static void INY(void){ //Increment Index Y by one
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RY);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t //INY\n");
 		if(bcd){
@@ -1370,56 +1738,62 @@ void INY(void){ //Increment Index Y by one
 	}
 }
 
-void JMP(void){ //Jump to address
+static void JMP(void){ //Jump to address
         if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
 	}else if(toSet == IR){
 		printf("\t //JMP\n");
 		call_corresponding_addressingMode(m[pc]);
-		if(toSet == DYNAMIC){
-			exit(1);
+		if((toSet == DYNAMIC) && (m[pc] == 0x6C)){
+			//no code for target, program stops like at BRK (see is_dynamic_jump)
+			printf("\t //vector %x in RAM, target not known at translation time\n", parameter);
+			printf("\t return 0;\n");
 		}else{
-			printf("\t cycles += %d;\n", cycles);
+			print_cycles("\t cycles += %d;\n", cycles);
 	                printf("\t goto L%x;\n", parameter);
 		}
 	}
 }
 
-void JSR(void){ //Jump to subroutine
+static void JSR(void){ //Jump to subroutine
 	if(toSet == DEFS){
-		static int counter = 0;
 		defs = 0;
                 uses = 0;
 		//add_used_helper_function(push8);
-		if(counter == 0){
-			for(int i = 0; i < jsr_counter; i++){
-				if(jsr[jsr_counter] == pc){
-					return;
-				}	
-			}
-			jsr[jsr_counter] = pc;
-			jsr_counter++;
+		uint16_t target = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
+		if(get_function(target) == target){
+			//subroutine is a function, no dispatch for return needed
+			return;
 		}
-		counter++;
+		for(int i = 0; i < jsr_counter; i++){
+			if(jsr[i] == pc){
+				return;
+			}	
+		}
+		jsr[jsr_counter] = pc;
+		jsr_counter++;
         }else if(toSet == IR){
-		//replaced by label stored
 		printf("\t //JSR\n");
 		call_corresponding_addressingMode(m[pc]);
-		printf("\t cycles += %d;\n", cycles);
+		print_cycles("\t cycles += %d;\n", cycles);
+		if(get_function(parameter) == parameter){
+			printf("\t sub_%x();\n", parameter);
+			return;
+		}
+		//replaced by label stored
 		printf("\t address = %d;\n", pc);
 		printf("\t goto L%x;\n", parameter);
 	}
 }
 
-void LDA(void){ //LDA... Load Accumulator with memory
+static void LDA(void){ //LDA... Load Accumulator with memory
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
 		if(!(code[m[pc]].addressingMode == 0x9)){
 			add_used_helper_function(read8);
 		}
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
@@ -1428,9 +1802,8 @@ void LDA(void){ //LDA... Load Accumulator with memory
 		if(is_absolute_address(m[pc])){
 			printf("\t ra = ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(") & 0xff;\n");
+				print_read8();
+                                printf(" & 0xff;\n");
                                 toSet = IR;
 			}else{
 		       		printf("%d & 0xff;\n", m[parameter]);
@@ -1453,11 +1826,10 @@ void LDA(void){ //LDA... Load Accumulator with memory
 	}
 }
 
-void LDX(void){ //LDX... Load Index X with memory
+static void LDX(void){ //LDX... Load Index X with memory
         if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
 		uses = 0;
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RX);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
@@ -1466,9 +1838,8 @@ void LDX(void){ //LDX... Load Index X with memory
 		if(is_absolute_address(m[pc])){
                         printf("\t rx = ");
 		       	if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(") & 0xff;\n");
+				print_read8();
+                                printf(" & 0xff;\n");
                                 toSet = IR;
 			}else{	
 				printf("%d & 0xff;\n", m[parameter]);
@@ -1491,14 +1862,13 @@ void LDX(void){ //LDX... Load Index X with memory
 	}
 }
 
-void LDY(void){ //LDY... Load Index Y with memory
+static void LDY(void){ //LDY... Load Index Y with memory
 	if(toSet == DEFS){
                 defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		if(is_absolute_address(m[pc])){
                         add_used_helper_function(read8);
                 }
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RY);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
@@ -1507,9 +1877,8 @@ void LDY(void){ //LDY... Load Index Y with memory
 		if(is_absolute_address(m[pc])){
                         printf("\t ry = ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-                                printf(") & 0xff;\n");
+				print_read8();
+                                printf(" & 0xff;\n");
                                 toSet = IR;
 			}else{
 				printf("%d & 0xff;\n", m[parameter]);
@@ -1532,7 +1901,7 @@ void LDY(void){ //LDY... Load Index Y with memory
 	}
 }
 
-void LSR(void){ //Shift One Bit Right (Memory or accumulator)
+static void LSR(void){ //Shift One Bit Right (Memory or accumulator)
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << NF) | (1 << ZF);
@@ -1542,14 +1911,13 @@ void LSR(void){ //Shift One Bit Right (Memory or accumulator)
                 }else{
 			usedRegisters = (1 << RA) | (1 << TEMP);
 		}
-		add_used_helper_function(setflag);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //LSR\n");
 		call_corresponding_addressingMode(m[pc]);
 	
 		if(is_absolute_address(m[pc]) == 0){
-			printf("\t setflag(%d,((ra & 0x1) > 0));\n", CF);
+			printf("\t flag_c = ra & 0x01;\n");
                 	printf("\t temp = ra >> 1;\n");
                 	printf("\t ra = (uint8_t) (temp & 0x00FF);\n");
 
@@ -1571,61 +1939,51 @@ void LSR(void){ //Shift One Bit Right (Memory or accumulator)
                 	}
 			printf("\t temp = "); 
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(")");
+				print_read8();
 			}else{
 				printf("%d", m[parameter]);
 			}
 			printf(" >> 1;\n");
-                	printf("\t setflag(%d, ((", CF); 
+                	printf("\t flag_c = ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-				call_corresponding_addressingMode(m[pc]);
-				printf(")");
+				print_read8();
 			}else{
 				printf("%d", m[parameter]);
 			}
-			printf(" & 0x1) > 0));\n");
-                	printf("\t write8(");
-			if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(", ");
-                        }else{
-				printf("%d, ", parameter);
-			}	
-			printf("(uint8_t) (temp & 0xFF));\n");
+			printf(" & 0x01;\n");
+			print_store_begin();
+			printf("(uint8_t) (temp & 0xFF)");
+			print_store_end();
 
 			if(optimization){
 				if(defs & (1 << ZF)){
-                               		code_for_ZF_dynamic(toSet);
+                               		code_for_ZF_flag(TEMP);
                         	}
                         	if(defs & (1 << NF)){
-                                	code_for_NF_dynamic(toSet);
+                                	code_for_NF_flag(TEMP);
                         	}
 			}else{
-				code_for_ZF_dynamic(toSet);
-                        	code_for_NF_dynamic(toSet);
+				code_for_ZF_flag(TEMP);
+                        	code_for_NF_flag(TEMP);
 			}
 		}
 	}
 }
 
-void NOP(void){
+static void NOP(void){
 	if(toSet == DEFS){
 		uses = 0;
 		defs = 0;
         }
 }
 
-void ORA(void){ //OR Memory with Accumulator 
+static void ORA(void){ //OR Memory with Accumulator 
 	if(toSet == DEFS){
 		uses = 0;
 		defs = (1 << NF) | (1 << ZF);
 		if(is_absolute_address(m[pc])){
                         add_used_helper_function(read8);
                 }
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
@@ -1634,9 +1992,8 @@ void ORA(void){ //OR Memory with Accumulator
 		if(is_absolute_address(m[pc]) == 1){
 			printf("\t ra = ra | ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(");\n");
+				print_read8();
+                                printf(";\n");
                                 toSet = IR;
                         }else{
 				printf("%d;\n", m[parameter]);
@@ -1657,39 +2014,41 @@ void ORA(void){ //OR Memory with Accumulator
 	}
 }
 
-void PHA(void){ //PusH Accumulator
+static void PHA(void){ //PusH Accumulator
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
 		add_used_helper_function(push8);
-		usedRegisters = (1 << RA);
+		usedRegisters = (1 << RA) | (1 << RS);
         }else if(toSet == IR){
 		printf("\t //PHA\n");
 		printf("\t push8(ra);\n");
 	}
 }
 
-void PHP(void){ //PusH Processor status
+static void PHP(void){ //PusH Processor status
         //printf("PHP:\n");
 	if(toSet == DEFS){
 		defs = 0;
-                //uses = (1 << NF) | (1 << VF) | (1 << DF) | (1 << IF) | (1 << ZF) | (1 << CF);
-		uses = 0;
+		//the pushed status byte is assembled from the lazily evaluated flags
+		uses = (1 << NF) | (1 << VF) | (1 << ZF) | (1 << CF);
 		add_used_helper_function(push8);
+		add_used_helper_function(get_flags);
+		usedRegisters = (1 << RS);
         }else if(toSet == IR){
 		printf("\t //PHP\n");
-		printf("\t push8(flags);\n");
+		//bits 4 (B) and 5 are set in the pushed byte
+		printf("\t push8(get_flags() | 0x30);\n");
 	}
 }
 
-void PLA(void){ //PuLl Accumulator
+static void PLA(void){ //PuLl Accumulator
         //printf("PLA:\n");
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		add_used_helper_function(pull8);
-		add_used_helper_function(setflag);
-		usedRegisters = (1 << RA);
+		usedRegisters = (1 << RA) | (1 << RS);
         }else if(toSet == IR){
 		printf("\t //PLA\n");
 		printf("\t ra = pull8();\n");
@@ -1708,18 +2067,20 @@ void PLA(void){ //PuLl Accumulator
 	}
 }
 
-void PLP(void){ //PuLl Processor status
+static void PLP(void){ //PuLl Processor status
 	if(toSet == DEFS){
-		defs = (1 << BF) | (1 << XX);
+		defs = (1 << NF) | (1 << VF) | (1 << BF) | (1 << XX) | (1 << ZF) | (1 << CF);
                 uses = 0;
 		add_used_helper_function(pull8);
+		add_used_helper_function(set_flags);
+		usedRegisters = (1 << RS);
         }else if(toSet == IR){
 		printf("\t //PLP \n");
-		printf("\t flags = pull8();\n");
+		printf("\t set_flags(pull8());\n");
 	}
 }
 
-void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
+static void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
@@ -1730,13 +2091,12 @@ void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
 		}else{
 			usedRegisters = (1 << RA) | (1 << TEMP);
 		}
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t //ROL\n");
 		if(is_absolute_address(m[pc]) == 0){
-			printf("\t temp = (ra << 1) + (flags & (1 << %d));\n", CF);
+			printf("\t temp = (ra << 1) + flag_c;\n");
                 	printf("\t ra = (uint8_t) (temp & 0xFF);\n");
-                	printf("\t setflag(%d, ((temp & 0xFF00) > 0));\n", CF);
+                	printf("\t flag_c = temp >> 8;\n");
 			if(optimization){
 				if(defs & (1 << NF)){
                                 	code_for_NF_flag(RA);
@@ -1754,39 +2114,33 @@ void ROL(void){ //ROL... Rotate one Bit left (memory or accumulator)
 
 			printf("\t temp = "); 
 			if(toSet == DYNAMIC){
-				printf("(read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
+				printf("(");
+                                print_read8();
                                 toSet = IR;
                         }else{
 				printf("(%d", m[parameter]); 
 			}
-			printf(" << 1) + (flags & (1 << %d));\n", CF);
-                	printf("\t write8(");
-		        if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(",");
-                        }else{	
-				printf("%d,", parameter);
-			}
-			printf(" (uint8_t) (temp & 0xFF));\n");
-                	printf("\t setflag(%d, ((temp & 0xFF00) > 0));\n", CF);
+			printf(" << 1) + flag_c;\n");
+			print_store_begin();
+			printf("(uint8_t) (temp & 0xFF)");
+			print_store_end();
+                	printf("\t flag_c = temp >> 8;\n");
 			if(optimization){
 				if(defs & (1 << ZF)){
-                 			code_for_ZF_dynamic(toSet);
+                 			code_for_ZF_flag(TEMP);
                 		}
                 		if(defs & (1 << NF)){
-                                	code_for_NF_dynamic(toSet);
+                                	code_for_NF_flag(TEMP);
                 		}
 			}else{
-				code_for_ZF_dynamic(toSet);
-				code_for_NF_dynamic(toSet);
+				code_for_ZF_flag(TEMP);
+				code_for_NF_flag(TEMP);
 			}
 		}
 	}
 }
 
-void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
+static void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
@@ -1797,12 +2151,11 @@ void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
                 }else{
 			usedRegisters = (1 << RA) | (1 <<4);
 		}
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t //ROR\n");
 		if(is_absolute_address(m[pc]) == 0){
-			printf("\t temp = ((flags & (1 << %d)) << 7) | (ra >> 1);\n", CF);
-                	printf("\t setflag(%d, (ra & 0x01));\n", CF);
+			printf("\t temp = (flag_c << 7) | (ra >> 1);\n");
+                	printf("\t flag_c = ra & 0x01;\n");
                 	printf("\t ra = (uint8_t) (temp & 0xFF);\n");
 			
 			if(optimization){
@@ -1824,81 +2177,80 @@ void ROR(void){ //ROR... Rotate one Bit right (memory or accumulator)
         	                return;
 	                }
 
-			printf("\t temp = ((flags & (1 << %d)) << 7) | ", CF);
+			printf("\t temp = (flag_c << 7) | ");
 			if(toSet == DYNAMIC){
-				printf("(read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
+				printf("(");
+                                print_read8();
                                 toSet = IR;
                         }else{
 				printf("(%d", m[parameter]);
 			}
 			printf(" >> 1);\n");
-                	printf("\t setflag(%d, (", CF);
+                	printf("\t flag_c = ");
 			if(toSet == DYNAMIC){
-				printf("read8(");
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(")");
+				print_read8();
                                 toSet = IR;
                         }else{
 				printf("%d", m[parameter]);
 			}
-			printf("& 0x01));\n");
-                	printf("\t write8("); 
-			if(toSet == DYNAMIC){
-                                call_corresponding_addressingMode(m[pc]);
-                                printf(",\n");
-                                toSet = IR;
-                        }else{
-				printf("%d,", parameter); 
-			}
-			printf(" (uint8_t) (temp & 0xFF));\n");
+			printf(" & 0x01;\n");
+			print_store_begin();
+			printf("(uint8_t) (temp & 0xFF)");
+			print_store_end();
+			toSet = IR;
 			if(optimization){
 				if(defs & (1 << ZF)){
-                        		code_for_ZF_dynamic(toSet);
+                        		code_for_ZF_flag(TEMP);
                 		}
                 		if(defs & (1 << NF)){
-                        		code_for_NF_dynamic(toSet);
+                        		code_for_NF_flag(TEMP);
                 		}
 			}else{
-				code_for_ZF_dynamic(toSet);
-				code_for_NF_dynamic(toSet);
+				code_for_ZF_flag(TEMP);
+				code_for_NF_flag(TEMP);
 			}
 		}
 	}
 }
 
-void RTI(void){ //Return from Interrupt
+static void RTI(void){ //Return from Interrupt
 	if(toSet == DEFS){
-		defs = (1 << BF);
+		defs = (1 << NF) | (1 << VF) | (1 << BF) | (1 << ZF) | (1 << CF);
                 uses = 0;
 		add_used_helper_function(pull8);
+		add_used_helper_function(set_flags);
+		usedRegisters = (1 << RS);
         }else if(toSet == IR){
-		printf("\t flags = pull8();\n");
-		printf("\t pc = pull8();\n");
-        	printf("\t pc |= (pull8() << 8);\n");
+		printf("\t //RTI\n");
+		printf("\t set_flags(pull8());\n");
+		//interrupted code is only known at runtime, program stops like at BRK (see JMP with vector in RAM)
+		printf("\t //return address not known at translation time\n");
+		printf("\t return 0;\n");
 	}
 }
 
-void RTS(void){ // return from subroutine
+static void RTS(void){ // return from subroutine
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
 		//add_used_helper_function(pull8);
         }else if(toSet == IR){
 		printf("\t //RTS\n");
-		printf("\t goto jump_table;\n");
+		if(get_function(pc) != -1){
+			printf("\t return;\n");
+		}else{
+			printf("\t goto jump_table;\n");
+		}
 	}
 }
 
-void SBC(void){ //SBC... subtract with carry
+static void SBC(void){ //SBC... subtract with carry
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << VF) | (1 << ZF) | (1 << CF);
                 uses = (1 << CF);
 		if(is_absolute_address(m[pc]) == 1){
 			add_used_helper_function(read8);
 		}
-		add_used_helper_function(setflag);
 		usedRegisters = (1 << RA) | (1 << TEMP);
         }else if(toSet == IR){
 		printf("\t //SBC\n");
@@ -1909,93 +2261,85 @@ void SBC(void){ //SBC... subtract with carry
 			}else{
 				printf("\t temp = (");
                         	if(toSet == DYNAMIC){
-                                	printf("read8(");
-                                	call_corresponding_addressingMode(m[pc]);
-                                	printf(")");
+                                	print_read8();
                         	}else{
                                 	printf("%d", m[parameter]);
                         	}
 				printf("^ 0xFF) + 1;\n");
 			}
-			printf("\t temp = add(ra, temp) - (~(flags & (1<<%d)) & (1 << %d));\n", CF, CF);
+			printf("\t temp = add(ra, temp) - (flag_c ^ 1);\n");
 		}else{
-			call_corresponding_addressingMode(m[pc]);
+			//ra - operand - borrow is computed as ra + (operand ^ 0xFF) + carry like ADC
 			if(is_absolute_address(m[pc]) == 1){
-				printf("\t temp = (ra + ");
+				printf("\t temp = ra + (");
 				if(toSet == DYNAMIC){
-					printf("read8(");
-                                	call_corresponding_addressingMode(m[pc]);
-                                	printf(")");
+					print_read8();
                                 	toSet = IR;
                         	}else{
-					printf("%d)", parameter);
+					printf("%d", m[parameter]);
 				}
-				printf("- (~(flags & (1<<%d)));\n", CF);
-				printf("\t ra = temp & 0xff;\n");
+				printf(" ^ 0xFF) + flag_c;\n");
 			}else{
-				printf("\t temp = (ra + %d) - (~(flags & (1<<%d));\n", parameter, CF);
-				printf("\t ra = temp & 0xff;\n");
+				printf("\t temp = ra + %d + flag_c;\n", parameter ^ 0xFF);
 			}
 		}
 	
 		if(optimization){	
 			if(defs & (1 << VF)){
-                        	code_for_set_VF_ADC_SBC(parameter);
+                        	code_for_set_VF_ADC_SBC(parameter ^ 0xFF);
                 	}
                		if(defs & (1 << CF)){
                         	code_for_CF_flag();
                 	}
                 	if(defs & (1 << ZF)){
-                        	code_for_ZF_flag(RA);
+                        	code_for_ZF_flag(TEMP);
                 	}
                		if(defs & (1 << NF)){
-                        	code_for_NF_flag(RA);
+                        	code_for_NF_flag(TEMP);
                 	}
 		}else{
-			code_for_set_VF_ADC_SBC(parameter);
+			code_for_set_VF_ADC_SBC(parameter ^ 0xFF);
 			code_for_CF_flag();
-			code_for_ZF_flag(RA);
-			code_for_NF_flag(RA);
+			code_for_ZF_flag(TEMP);
+			code_for_NF_flag(TEMP);
 		}
+		printf("\t ra = (uint8_t) temp & 0xFF;\n");
 	}
 }
 
-void SEC(void){ //SEC... Set Carry Flag
+static void SEC(void){ //SEC... Set Carry Flag
 	if(toSet == DEFS){
 		defs = (1 << CF);
                 uses = 0;
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
-		printf("\t setflag(CF, 1);\n");
+		printf("\t flag_c = 1;\n");
 	}
 }
 
-void SED(void){ //SED... set decimal flag
+static void SED(void){ //SED... set decimal flag
 	if(toSet == DEFS){
 		defs = (1 << DF);
                 uses = 0;
 		add_used_helper_function(convert_number_to_bcd);
 		add_used_helper_function(convert_bcd_to_number);
-		add_used_helper_function(setflag);
 		bcd = 1;
         }else if(toSet == IR){
-		printf("\t setflag(DF,1);\n");
+		printf("\t flags |= (1 << %d);\n", DF);
 	}
 }
 
-void SEI(void){ //Set Interrupt Disable Status
+static void SEI(void){ //Set Interrupt Disable Status
 	if(toSet == DEFS){
-		defs = (1 << BF);
+		defs = (1 << IF);
                 uses = 0;
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
-		printf("\t setflag(BF, 1);\n");
+		printf("\t flags |= (1 << %d);\n", IF);
 	}
 }
 
 
 
-void TAX(void){ // Transfer Accumulator to Index X
+static void TAX(void){ // Transfer Accumulator to Index X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
@@ -2017,12 +2361,11 @@ void TAX(void){ // Transfer Accumulator to Index X
 	}
 }
 
-void TAY(void){ // Transfer Accumulator to Index Y
+static void TAY(void){ // Transfer Accumulator to Index Y
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RA) | (1 << RY);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t ry = ra;\n");
 		if(optimization){
@@ -2040,12 +2383,11 @@ void TAY(void){ // Transfer Accumulator to Index Y
 	}
 }
 
-void TSX(void){ //Transfer Stackpointer to X
+static void TSX(void){ //Transfer Stackpointer to X
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RX) | (1 << RS);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t rx = rs;\n");
 		if(optimization){
@@ -2063,12 +2405,11 @@ void TSX(void){ //Transfer Stackpointer to X
 	}
 }
 
-void TXA(void){ // Transfer Index X to  Accumulator
+static void TXA(void){ // Transfer Index X to  Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RA) | (1 << RX);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t ra = rx;\n");
 		if(optimization){
@@ -2086,7 +2427,7 @@ void TXA(void){ // Transfer Index X to  Accumulator
 	}
 }
 
-void TXS(void){ //Transfer X to Stackpointer
+static void TXS(void){ //Transfer X to Stackpointer
 	if(toSet == DEFS){
 		defs = 0;
 		uses = 0;
@@ -2096,12 +2437,11 @@ void TXS(void){ //Transfer X to Stackpointer
 	}
 }
 
-void TYA(void){ // Transfer Index Y to  Accumulator
+static void TYA(void){ // Transfer Index Y to  Accumulator
 	if(toSet == DEFS){
 		defs = (1 << NF) | (1 << ZF);
                 uses = 0;
 		usedRegisters = (1 << RA) | (1 << RY);
-		add_used_helper_function(setflag);
         }else if(toSet == IR){
 		printf("\t ra = ry;\n");
 		if(optimization){
@@ -2121,58 +2461,58 @@ void TYA(void){ // Transfer Index Y to  Accumulator
 
 /* "Illegal" Opcodes - not supported by translator*/
 
-void ALR(void){ //A AND operand + LSR
+static void ALR(void){ //A AND operand + LSR
 }
 
-void ANC(void){ //A AND operand + set C as ASL
+static void ANC(void){ //A AND operand + set C as ASL
 }
 
-void ANC2(void){ // A AND operand + set C as ROL
+static void ANC2(void){ // A AND operand + set C as ROL
 }
 
-void ARR(void){ //A AND operand + ROR
+static void ARR(void){ //A AND operand + ROR
 }
 
-void DCP(void){ //DEC operand + CMP oper
+static void DCP(void){ //DEC operand + CMP oper
 }
 
-void ISC(void){ //INC operand + SBC operand
+static void ISC(void){ //INC operand + SBC operand
 }
 
-void LAS(void){ //LDA/TSX operand
+static void LAS(void){ //LDA/TSX operand
 }
 
-void LAX(void){ //LDA operand + LDX operand
+static void LAX(void){ //LDA operand + LDX operand
 }
 
-void RLA(void){ //ROL operand + AND operand
+static void RLA(void){ //ROL operand + AND operand
 }
 
-void RRA(void){ //ROR operand + ADC Operand
+static void RRA(void){ //ROR operand + ADC Operand
 }
 
-void SAX(void){ // A and X are put on bus at the same time -> like A AND X
+static void SAX(void){ // A and X are put on bus at the same time -> like A AND X
 }
 
-void SBX(void){ //CMP and DEC at onces
+static void SBX(void){ //CMP and DEC at onces
 }
 
-void SLO(void){ //ASL operand + ORA operand
+static void SLO(void){ //ASL operand + ORA operand
 }
 
-void SRE(void){ //LSR operand + EOR operand
+static void SRE(void){ //LSR operand + EOR operand
 }
 
-void USBC(void){ //SBC + NOP
+static void USBC(void){ //SBC + NOP
 }
 
-void JAM(void){ //freeze the CPU with $FF on data bus
+static void JAM(void){ //freeze the CPU with $FF on data bus
      	printf("//JAM\n");
 	printf("\t return 0;\n");
 }
 
 /* Instructions */
-void STA(void){ //STA... store accumulator in memory
+static void STA(void){ //STA... store accumulator in memory
         //printf("STA:\n");
 	if(toSet == DEFS){
 		defs = 0;
@@ -2181,6 +2521,7 @@ void STA(void){ //STA... store accumulator in memory
 		if(!((code[m[pc]].addressingMode == 0x5) || (code[m[pc]].addressingMode == 0x0d))){
 			add_used_helper_function(read8);
 		}
+		usedRegisters = (1 << RA);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
 		printf("\t //STA\n");
@@ -2200,19 +2541,15 @@ void STA(void){ //STA... store accumulator in memory
                         return;
                 }
 
-                printf("\t write8(");
-                if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                        printf(", ra);\n");
-                        toSet = IR;
-                }else{
-                        printf("%d, ra);\n", parameter);
-                }
+                print_store_begin();
+                printf("ra");
+                print_store_end();
+                toSet = IR;
 
 	}
 }
 
-void STX(void){ //STA... store Index X in memory
+static void STX(void){ //STA... store Index X in memory
         if(toSet == DEFS){
                 defs = 0;
                 uses = 0;
@@ -2220,6 +2557,7 @@ void STX(void){ //STA... store Index X in memory
                 if(!((code[m[pc]].addressingMode == 0x5) || (code[m[pc]].addressingMode == 0x0d))){
                         add_used_helper_function(read8);
                 }
+		usedRegisters = (1 << RX);
 		check_for_indexed_addressing(m[pc]);
 	}else if(toSet == IR){
 		printf("\t //STX\n");
@@ -2239,19 +2577,15 @@ void STX(void){ //STA... store Index X in memory
                         return;
                 }
 
-                printf("\t write8(");
-                if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                        printf(", rx);\n");
-                        toSet = IR;
-                }else{
-                        printf("%d, rx);\n", parameter);
-                }
+                print_store_begin();
+                printf("rx");
+                print_store_end();
+                toSet = IR;
                
 	}
 }
 
-void STY(void){ //STA... store Index Y in memory
+static void STY(void){ //STA... store Index Y in memory
         if(toSet == DEFS){
                 defs = 0;
                 uses = 0;
@@ -2259,6 +2593,7 @@ void STY(void){ //STA... store Index Y in memory
                 if(!((code[m[pc]].addressingMode == 0x5) || (code[m[pc]].addressingMode == 0x0d))){
                         add_used_helper_function(read8);
                 }
+		usedRegisters = (1 << RY);
 		check_for_indexed_addressing(m[pc]);
         }else if(toSet == IR){
 		printf("\t //STY\n");
@@ -2278,97 +2613,58 @@ void STY(void){ //STA... store Index Y in memory
                         return;
                 }
 
-                printf("\t write8(");
-                if(toSet == DYNAMIC){
-                        call_corresponding_addressingMode(m[pc]);
-                        printf(", ry);\n");
-                        toSet = IR;
-                }else{
-                        printf("%d, ry);\n", parameter);
-                }
+                print_store_begin();
+                printf("ry");
+                print_store_end();
+                toSet = IR;
 	}
 }
 
 /* Addressing Modes */
-void
+static void
 add_rom_address(uint16_t address){
-        for(int i = 0; i < rom_addr; i++){
-                if(rom_addresses[i] == address){
-                        return;
-                }
-        }
-        rom_addresses[rom_addr] = address;
-        rom_addr++;
-        return;
+	//shared by all representations, see print_rom_table
+	address_attributes[address] |= ATTR_ROM_DATA;
 }
 
-void
+static void
 add_rriot_address(uint16_t address){
-        for(int i = 0; i < rriot_addr; i++){
-                if(rriot_rom[i] == address){
-                        return;
-                }
-        }
-
-        rriot_rom[rriot_addr] = address;
-        rriot_addr++;
-        return;
+	address_attributes[address] |= ATTR_RRIOT_DATA;
 }
 
-void
+static void
 add_rom_range_to_rom_addresses(uint16_t address){
-        //add range accessible with 8-Bit Register (possible values: -128 to 127)
-        uint16_t start;
-        uint16_t lowest = address + 0xff80;
-        uint16_t end;
-        uint32_t highest = address + 0x007f;
-
-        if(highest > 0xffff){
-                end = 0xffff;
-        }else{
-                end = highest & 0xffff;
-        }
-        start = 0xf000;
-        if((lowest & 0xF000) == 0xF000){
-                //no overflow
-                start = lowest;
-        }
+	//add range reachable with unsigned 8-Bit index register (address + 0 ... address + 255) which is ROM in memory map
+	int start = address;
+	int end = address + 0xff;
 
-        for(uint16_t i = start; i <= end; i++){
-                if((i >= start) && (i <= end)){
-                        add_rom_address(i);
-                }
-        }
+	if(end > 0xffff){
+		end = 0xffff;
+	}
+	for(int i = start; i <= end; i++){
+		if(is_in_ROM(i) && (get_memory_region(i) != REGION_RRIOT_ROM)){
+			add_rom_address(i);
+		}
+	}
 }
 
-void
+static void
 add_rriot_range_to_rom_addresses(uint16_t address){
-        uint16_t start;
-        uint16_t lowest = address + 0xff80;
-        uint16_t end;
-        uint32_t highest = address + 0x007f;
-        //address in RRIOT ROM
-        if(highest > 0x8fff){
-                end = 0x8fff;
-        }else{
-                end = highest & 0xffff;
-        }
-        start = 0x8c00;
-        if((lowest & 0x8000) == 0x8000){
-                start = RRIOT_ROM_START;
-        }else{
-                start = lowest;
-        }
-
-        for(uint16_t i = start; i <= end; i++){
-                if((i >= start) && (i <= end)){
-                        add_rriot_address(i);
-                }
-        }
+	//add range reachable with unsigned 8-Bit index register (address + 0 ... address + 255) which is RRIOT ROM in memory map
+	int start = address;
+	int end = address + 0xff;
 
+	if(end > 0xffff){
+		end = 0xffff;
+	}
+	for(int i = start; i <= end; i++){
+		if(get_memory_region(i) == REGION_RRIOT_ROM){
+			add_rriot_address(i);
+		}
+	}
 }
 
-void absolute(void){
+static void absolute(void){
 	if(toSet == BYTES){
                 bytes = 3;
 		parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
@@ -2377,29 +2673,20 @@ void absolute(void){
         }else{
                 parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
                 bytes = 3;
-                if(((parameter >= RRIOT_RAM_START) && (parameter < RRIOT_ROM_START)) || (parameter <= 0xff)){
+                //only ROM is known at translation time, RAM and I/O are accessed at runtime
+                if(!is_in_ROM(parameter)){
                         toSet = DYNAMIC;
                 }
         }
 }
 
-void absolute_x (void){ //address is address incremented with X (with carry)
-	static int visits = 0;
+static void absolute_x (void){ //address is address incremented with X (with carry)
         if(toSet == BYTES){
                 bytes = 3;
-#if WCET
-		cycles++;
-#endif
-                if(visits == 0){
-                        parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
-                        //save rom range for dynamic access
-                        if(parameter >= 0xf000){
-                                add_rom_range_to_rom_addresses(parameter);
-                        }else{
-                                add_rriot_range_to_rom_addresses(parameter);
-                        }
-                }
-
+                parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
+                //save rom range for dynamic access
+                add_rom_range_to_rom_addresses(parameter);
+                add_rriot_range_to_rom_addresses(parameter);
         }else if(toSet == DYNAMIC){
                 printf("%d + rx", parameter);
         }else{
@@ -2407,26 +2694,15 @@ void absolute_x (void){ //address is address incremented with X (with carry)
                 parameter = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
                 bytes = 3;
         }
-        visits++; 
 }
 
-void absolute_y(void){ //address is address incremented with Y (with carry)
-	static int visits = 0;
+static void absolute_y(void){ //address is address incremented with Y (with carry)
         if(toSet == BYTES){
                 bytes = 3;
-#if WCET
-		cycles++;
-#endif
-                if(visits == 0){
-                        parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
-                        //save rom range for dynamic access
-                        if(parameter >= 0xf000){
-                                add_rom_range_to_rom_addresses(parameter);
-                        }else{
-                                add_rriot_range_to_rom_addresses(parameter);
-                        }
-                }
-
+                parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
+                //save rom range for dynamic access
+                add_rom_range_to_rom_addresses(parameter);
+                add_rriot_range_to_rom_addresses(parameter);
         }else if(toSet == DYNAMIC){
                 printf("%d + ry", parameter);
         }else{
@@ -2434,10 +2710,9 @@ void absolute_y(void){ //address is address incremented with Y (with carry)
                 parameter = m[pc+1] | ((uint16_t) m[pc + 2] << 8);
                 bytes = 3;
         }
-        visits++;
 }
 
-void immediate(void){
+static void immediate(void){
 	if(toSet == BYTES){
                 bytes = 2;
         }else{
@@ -2446,39 +2721,35 @@ void immediate(void){
         }
 }
 
-void implied(void){
+static void implied(void){
         bytes = 1;
 }
 
-void indirect(void){
-      	if(toSet == BYTES){
-                bytes = 3;
-        }else{
-                bytes = 3;
-                uint16_t vector = m[pc+1] | ((uint16_t) m[pc+2] << 8);
-                if(is_in_ROM(vector)){
-                        parameter = m[vector] | ((uint16_t) m[vector + 1] << 8);
-                        if(!is_in_ROM(parameter)){
-                                printf("jump address is in RAM!!!\n");
-                                toSet = DYNAMIC;
-                        }
-                }else{
-                        printf("jump address is in RAM!!!\n");
-                        toSet = DYNAMIC;
-                }
-        }
+static void indirect(void){
+	if(toSet == BYTES){
+		bytes = 3;
+	}else{
+		bytes = 3;
+		uint16_t vector = m[pc+1] | ((uint16_t) m[pc+2] << 8);
+		if(is_in_ROM(vector)){
+			//target was followed by code discovery, it has a label
+			parameter = m[vector] | ((uint16_t) m[(uint16_t) (vector + 1)] << 8);
+		}else{
+			//vector in RAM: target only known at runtime
+			parameter = vector;
+			toSet = DYNAMIC;
+		}
+	}
 }
 
-void indirect_y(void){
+static void indirect_y(void){
 	if(toSet == BYTES){
                 bytes = 2;
-#if WCET
-		cycles++;
-#endif
         }else if(toSet == DYNAMIC){
                 //address = m[pc+1];
                 //parameter = m[address] | (m[address+1] << 8) + ry;
-                printf("(read8(%d) | ((uint16_t) (read8(%d) + 1) << 8)) + ry)", parameter, parameter);
+                //pointer is read from zero page, its high byte wraps around to 0x00
+                printf("((read8(%d) | ((uint16_t) read8(%d) << 8)) + ry)", parameter, (parameter + 1) & 0xff);
         }else{
                 parameter = m[pc+1];
                 toSet = DYNAMIC;
@@ -2486,13 +2757,14 @@ void indirect_y(void){
         }
 }
 
-void indexed_x(void){ //pointer is modified with x
+static void indexed_x(void){ //pointer is modified with x
 	if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
                 // address = (m[pc+1] + r[RX]) & 0x00FF;
                 // parameter = m[address] | (m[address+1] << 8);
-                printf("(read8(%d) + rx) | (((uint16_t) (read8(%d) + rx) + 1) << 8)", parameter, parameter);
+                //X is added to address of pointer, pointer stays in zero page
+                printf("(read8((%d + rx) & 0xff) | ((uint16_t) read8((%d + rx + 1) & 0xff) << 8))", parameter, parameter);
         }else{
                 parameter = m[pc+1];
                 toSet = DYNAMIC;
@@ -2500,7 +2772,7 @@ void indexed_x(void){ //pointer is modified with x
         }
 }
 
-void relative(void){
+static void relative(void){
 	bytes = 2;
 	parameter = m[pc + 1];
 	if((parameter & 0x80) > 0){
@@ -2509,7 +2781,7 @@ void relative(void){
 	parameter = (pc + 2) + parameter;
 }
 
-void zeropage(void){ //hi-byte is 0x00
+static void zeropage(void){ //hi-byte is 0x00
 	if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
@@ -2521,7 +2793,7 @@ void zeropage(void){ //hi-byte is 0x00
 	}
 }
 
-void zeropage_x(void){ //address is address incremented with x (without carry)
+static void zeropage_x(void){ //address is address incremented with x (without carry)
 	if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
@@ -2533,7 +2805,7 @@ void zeropage_x(void){ //address is address incremented with x (without carry)
         }
 }
 
-void zeropage_y(void){ //address is address incremented with y (without carry)
+static void zeropage_y(void){ //address is address incremented with y (without carry)
         if(toSet == BYTES){
                 bytes = 2;
         }else if(toSet == DYNAMIC){
@@ -2546,3 +2818,49 @@ void zeropage_y(void){ //address is address incremented with y (without carry)
 }
 
 
+
+/* Representation */
+static void
+print_used_helper_functions(void){
+	for(int i = 0; i < helperFunctions; i++){
+		if((used_helper_functions[i] == read8) || (used_helper_functions[i] == write8)){
+			print_page_table();
+			print_synchronisation();
+			break;
+		}
+	}
+	for(int i = 0; i < helperFunctions; i++){
+		(*used_helper_functions[i])();
+		printf("\n\n");
+	}
+}
+
+static void (*opcodes[NUMBER_OF_MNEMONICS])(void) = {
+	[OP_ADC] = ADC, [OP_AND] = AND, [OP_ASL] = ASL, [OP_BCC] = BCC, [OP_BCS] = BCS, [OP_BEQ] = BEQ,
+	[OP_BIT] = BIT, [OP_BMI] = BMI, [OP_BNE] = BNE, [OP_BPL] = BPL, [OP_BRK] = BRK, [OP_BVC] = BVC,
+	[OP_BVS] = BVS, [OP_CLC] = CLC, [OP_CLD] = CLD, [OP_CLI] = CLI, [OP_CLV] = CLV, [OP_CMP] = CMP,
+	[OP_CPX] = CPX, [OP_CPY] = CPY, [OP_DEC] = DEC, [OP_DEX] = DEX, [OP_DEY] = DEY, [OP_EOR] = EOR,
+	[OP_INC] = INC, [OP_INX] = INX, [OP_INY] = INY, [OP_JMP] = JMP, [OP_JSR] = JSR, [OP_LDA] = LDA,
+	[OP_LDX] = LDX, [OP_LDY] = LDY, [OP_LSR] = LSR, [OP_NOP] = NOP, [OP_ORA] = ORA, [OP_PHA] = PHA,
+	[OP_PHP] = PHP, [OP_PLA] = PLA, [OP_PLP] = PLP, [OP_ROL] = ROL, [OP_ROR] = ROR, [OP_RTI] = RTI,
+	[OP_RTS] = RTS, [OP_SBC] = SBC, [OP_SEC] = SEC, [OP_SED] = SED, [OP_SEI] = SEI, [OP_STA] = STA,
+	[OP_STX] = STX, [OP_STY] = STY, [OP_TAX] = TAX, [OP_TAY] = TAY, [OP_TSX] = TSX, [OP_TXA] = TXA,
+	[OP_TXS] = TXS, [OP_TYA] = TYA, [OP_ALR] = ALR, [OP_ANC] = ANC, [OP_ANC2] = ANC2, [OP_ARR] = ARR,
+	[OP_DCP] = DCP, [OP_ISC] = ISC, [OP_LAS] = LAS, [OP_LAX] = LAX, [OP_RLA] = RLA, [OP_RRA] = RRA,
+	[OP_SAX] = SAX, [OP_SBX] = SBX, [OP_SLO] = SLO, [OP_SRE] = SRE, [OP_USBC] = USBC, [OP_JAM] = JAM,
+};
+
+Backend c_backend = {
+	.name = "c",
+	.opcodes = opcodes,
+	.addressing_mode = call_corresponding_addressingMode,
+	.prolog = print_prolog,
+	.global_vars_and_functions = print_global_vars_and_functions,
+	.helper_functions = print_used_helper_functions,
+	.main = print_main,
+	.epilog = print_epilog,
+	.function_prolog = print_function_prolog,
+	.function_epilog = print_function_epilog,
+	.add_cycles = print_add_cycles,
+	.delay_loop = print_delay_loop
+};
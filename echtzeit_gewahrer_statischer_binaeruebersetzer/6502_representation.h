@@ -0,0 +1,171 @@
+/* functions of a representation module (6502_instructions_c.c, 6502_instructions_avr.c),
+ * local to the module and exported by its Backend (see 6502_instructions.h) */
+
+static void
+call_corresponding_addressingMode(uint8_t opcode);
+
+static void print_prolog(void);
+static void print_global_vars_and_functions(void);
+static void print_main(void);
+static void print_epilog(void);
+/* Instructions */
+
+static void ADC(void);
+
+static void AND(void);
+
+static void ASL(void);
+
+static void BCC(void);
+static void BCS(void);
+
+static void BEQ(void);
+static void BIT(void);
+
+static void BMI(void);
+static void BNE(void);
+
+static void BPL(void);
+
+static void BRK(void);
+
+static void BVC(void);
+
+static void BVS(void);
+static void CLC(void);
+static void CLD(void);
+
+static void CLI(void);
+
+static void CLV(void);
+
+static void CMP(void);
+
+static void CPX(void);
+
+static void CPY(void);
+static void DEC(void);
+static void DEX(void);
+
+static void DEY(void);
+
+static void EOR(void);
+
+static void INC(void);
+
+static void INX(void);
+
+static void INY(void);
+
+static void JMP(void);
+
+static void JSR(void);
+
+static void LDA(void);
+
+static void LDX(void);
+
+static void LDY(void);
+static void LSR(void);
+
+static void NOP(void);
+static void ORA(void);
+
+static void PHA(void);
+static void PHP(void);
+
+static void PLA(void);
+
+static void PLP(void);
+
+static void ROL(void);
+
+static void ROR(void);
+
+static void RTI(void);
+static void RTS(void);
+
+static void SBC(void);
+
+static void SEC(void);
+
+static void SED(void);
+
+static void SEI(void);
+
+
+static void TAX(void);
+
+static void TAY(void);
+
+static void TSX(void);
+
+static void TXA(void);
+
+static void TXS(void);
+
+static void TYA(void);
+/* "Illegal" Opcodes */
+
+static void ALR(void);
+
+static void ANC(void);
+
+static void ANC2(void);
+
+static void ARR(void);
+static void DCP(void);
+
+static void ISC(void);
+
+static void LAS(void);
+
+static void LAX(void);
+
+static void RLA(void);
+
+static void RRA(void);
+
+static void SAX(void);
+
+static void SBX(void);
+
+static void SLO(void);
+
+static void SRE(void);
+
+static void USBC(void);
+
+static void JAM(void);
+
+/* Instructions */
+static void STA(void);
+
+static void STX(void);
+
+static void STY(void);
+
+/* Addressing Modes */
+
+static void absolute(void);
+
+static void absolute_x (void);
+
+static void absolute_y(void);
+
+static void immediate(void);
+
+static void implied(void);
+
+static void indirect(void);
+
+static void indirect_y(void);
+
+static void indexed_x(void);
+
+static void relative(void);
+
+static void zeropage(void);
+static void zeropage_x(void);
+
+static void zeropage_y(void);
@@ -4,80 +4,88 @@
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <getopt.h>
 
 #include "6502_instructions.h"
 
 #define MEMORY 1024 * 64
-#define ROM_SIZE 1024 * 5
-#define MAX_ROM 0xffff
-#define MIN_ROM 0xf000
-#define MAX_RRIOT_ROM 0x8fff
-#define MIN_RRIOT_ROM 0x8c00
 #define RAM_SIZE 256
-#define MIN_IO 0x8b00
-#define MAX_IO 0x8b7f
-//0xfe2f
-#define END_PROGRAM 0xfe2f
-#define IO_START 0xfeb6
-#define SKIP_BYTE1 0xfeed
-#define SKIP_BYTE2 0xff03
-#define SKIP_BYTE3 0xff7c
-#define START_TABLE 0xffc6
+#define MAX_REGIONS 32
 
 /* memory addressable by 6502 */
 uint8_t m[MEMORY];
+
+/* memory map of 6502 system, regions declared later override earlier ones.
+ * Default is the system of the thesis, it can be replaced by a memory map file (load_memory_map) */
+MemoryRegion memory_map[MAX_REGIONS] = {
+	{0x0000, 0x01ff, REGION_RAM},
+	{0x8b00, 0x8b7f, REGION_IO},
+	{0x8b80, 0x8bff, REGION_RRIOT_RAM},
+	{0x8c00, 0x8fff, REGION_RRIOT_ROM},
+	{0xf000, 0xffff, REGION_ROM},
+	//tables of thesis ROM and vectors
+	{0xfe2f, 0xfeb5, REGION_DATA},
+	{0xffc6, 0xffff, REGION_DATA}
+};
+int number_of_regions = 7;
+//kind of region of every address, built from memory map
+uint8_t region_kind[MEMORY];
+//index of every address in the array of the generated code representing its kind of region
+//(m for RAM, rriot_ram for RRIOT RAM), addresses of a kind are stored in address order
+uint16_t region_index[MEMORY];
+int region_size[REGION_DATA + 1];
 /* flag bit numbers */
 enum { CF=0, ZF, IF, DF, BF, XX, VF, NF };
 
 /* table for opcodes, addressing mode and cycles */
 struct Instructions code[256] = {
-		{&BRK, 0x8, 7},{&ORA, 0x1, 6},{&JAM, 0x8, 1},{&SLO, 0x1, 8},{&NOP, 0x5, 3},{&ORA, 0x5, 3},{&ASL, 0x5, 5},{&SLO, 0x5, 5},
-                {&PHP, 0x8, 3},{&ORA, 0x9, 2},{&ASL, 0xa, 2},{&ANC, 0x9, 2},{&NOP, 0xd, 4},{&ORA, 0xd, 4},{&ASL, 0xd, 6},{&SLO, 0xd, 6},
+		{OP_BRK, 0x8, 7},{OP_ORA, 0x1, 6},{OP_JAM, 0x8, 1},{OP_SLO, 0x1, 8},{OP_NOP, 0x5, 3},{OP_ORA, 0x5, 3},{OP_ASL, 0x5, 5},{OP_SLO, 0x5, 5},
+                {OP_PHP, 0x8, 3},{OP_ORA, 0x9, 2},{OP_ASL, 0xa, 2},{OP_ANC, 0x9, 2},{OP_NOP, 0xd, 4},{OP_ORA, 0xd, 4},{OP_ASL, 0xd, 6},{OP_SLO, 0xd, 6},
 
-                {&BPL, 0x0, 2},{&ORA, 0x11, 5},{&JAM, 0x8, 1},{&SLO, 0x11, 8},{&NOP, 0x15, 4},{&ORA, 0x15, 4},{&ASL, 0x15, 6},{&SLO, 0x15, 6},
-                {&CLC, 0x8, 2},{&ORA, 0x19, 4},{&NOP, 0x8, 2},{&SLO, 0x19, 7},{&NOP, 0x1d, 4},{&ORA, 0x1d, 4},{&ASL, 0x1d, 7},{&SLO, 0x1d, 6},
+                {OP_BPL, 0x0, 2},{OP_ORA, 0x11, 5},{OP_JAM, 0x8, 1},{OP_SLO, 0x11, 8},{OP_NOP, 0x15, 4},{OP_ORA, 0x15, 4},{OP_ASL, 0x15, 6},{OP_SLO, 0x15, 6},
+                {OP_CLC, 0x8, 2},{OP_ORA, 0x19, 4},{OP_NOP, 0x8, 2},{OP_SLO, 0x19, 7},{OP_NOP, 0x1d, 4},{OP_ORA, 0x1d, 4},{OP_ASL, 0x1d, 7},{OP_SLO, 0x1d, 6},
 
-                {&JSR, 0xd, 6},{&AND, 0x1, 6},{&JAM, 0x8, 1},{&RLA, 0x1, 8},{&BIT, 0x5, 3},{&AND, 0x5, 3},{&ROL, 0x5, 5},{&RLA, 0x5, 5},
-                {&PLP, 0x8, 4},{&AND, 0x9, 4},{&ROL, 0xa, 2},{&ANC2, 0x9, 2},{&BIT, 0xd, 4},{&AND, 0xd, 4},{&ROL, 0xd, 6},{&RLA, 0xd, 6},
+                {OP_JSR, 0xd, 6},{OP_AND, 0x1, 6},{OP_JAM, 0x8, 1},{OP_RLA, 0x1, 8},{OP_BIT, 0x5, 3},{OP_AND, 0x5, 3},{OP_ROL, 0x5, 5},{OP_RLA, 0x5, 5},
+                {OP_PLP, 0x8, 4},{OP_AND, 0x9, 4},{OP_ROL, 0xa, 2},{OP_ANC2, 0x9, 2},{OP_BIT, 0xd, 4},{OP_AND, 0xd, 4},{OP_ROL, 0xd, 6},{OP_RLA, 0xd, 6},
 
-                {&BMI, 0x0, 2},{&AND, 0x11, 5},{&JAM, 0x8, 1},{&RLA, 0x11, 8},{&NOP, 0x15, 4},{&AND, 0x15, 4},{&ROL, 0x15, 6},{&RLA, 0x15, 5},
-                {&SEC, 0x8, 2},{&AND, 0x19, 4},{&NOP, 0x8, 2},{&RLA, 0x19, 7},{&NOP, 0x1d, 4},{&AND, 0x1d, 4},{&ROL, 0x1d, 7},{&RLA, 0x1d, 7},
+                {OP_BMI, 0x0, 2},{OP_AND, 0x11, 5},{OP_JAM, 0x8, 1},{OP_RLA, 0x11, 8},{OP_NOP, 0x15, 4},{OP_AND, 0x15, 4},{OP_ROL, 0x15, 6},{OP_RLA, 0x15, 5},
+                {OP_SEC, 0x8, 2},{OP_AND, 0x19, 4},{OP_NOP, 0x8, 2},{OP_RLA, 0x19, 7},{OP_NOP, 0x1d, 4},{OP_AND, 0x1d, 4},{OP_ROL, 0x1d, 7},{OP_RLA, 0x1d, 7},
 
-                {&RTI, 0x8, 6},{&EOR, 0x1, 6},{&JAM, 0x8, 1},{&SRE, 0x1, 8},{&NOP, 0x5, 3},{&EOR, 0x5, 3},{&LSR, 0x5, 5},{&SRE, 0x5, 5},
-                {&PHA, 0x8, 3},{&EOR, 0x9, 2},{&LSR, 0xa, 2},{&ALR, 0x9, 2},{&JMP, 0xd, 3},{&EOR, 0xd, 4},{&LSR, 0xd, 7},{&SRE, 0xd, 6},
+                {OP_RTI, 0x8, 6},{OP_EOR, 0x1, 6},{OP_JAM, 0x8, 1},{OP_SRE, 0x1, 8},{OP_NOP, 0x5, 3},{OP_EOR, 0x5, 3},{OP_LSR, 0x5, 5},{OP_SRE, 0x5, 5},
+                {OP_PHA, 0x8, 3},{OP_EOR, 0x9, 2},{OP_LSR, 0xa, 2},{OP_ALR, 0x9, 2},{OP_JMP, 0xd, 3},{OP_EOR, 0xd, 4},{OP_LSR, 0xd, 7},{OP_SRE, 0xd, 6},
 
-                {&BVC, 0x0, 2},{&EOR, 0x11, 5},{&JAM, 0x8, 1},{&SRE, 0x11, 8},{&NOP, 0x15, 4},{&EOR, 0x15, 4},{&LSR, 0x15, 6},{&SRE, 0x15, 6},
-                {&CLI, 0x8, 2},{&EOR, 0x19, 4},{&NOP, 0x8, 2},{&SRE, 0x19, 7},{&NOP, 0x1d, 4},{&EOR, 0x1d, 4},{&LSR, 0x1d, 7},{&SRE, 0x1d, 7},
+                {OP_BVC, 0x0, 2},{OP_EOR, 0x11, 5},{OP_JAM, 0x8, 1},{OP_SRE, 0x11, 8},{OP_NOP, 0x15, 4},{OP_EOR, 0x15, 4},{OP_LSR, 0x15, 6},{OP_SRE, 0x15, 6},
+                {OP_CLI, 0x8, 2},{OP_EOR, 0x19, 4},{OP_NOP, 0x8, 2},{OP_SRE, 0x19, 7},{OP_NOP, 0x1d, 4},{OP_EOR, 0x1d, 4},{OP_LSR, 0x1d, 7},{OP_SRE, 0x1d, 7},
 
-                {&RTS, 0x8, 6},{&ADC, 0x1, 6},{&JAM, 0x8, 1},{&RRA, 0x1, 8},{&NOP, 0x5, 3},{&ADC, 0x5, 3},{&ROR, 0x5, 5},{&RRA, 0x5, 5},
-                {&PLA, 0x8, 4},{&ADC, 0x9, 2},{&ROR, 0xa, 2},{&ARR, 0x9, 2},{&JMP, 0x2d, 5},{&ADC, 0xd, 4},{&ROR, 0xd, 6},{&RRA, 0xd, 6},
+                {OP_RTS, 0x8, 6},{OP_ADC, 0x1, 6},{OP_JAM, 0x8, 1},{OP_RRA, 0x1, 8},{OP_NOP, 0x5, 3},{OP_ADC, 0x5, 3},{OP_ROR, 0x5, 5},{OP_RRA, 0x5, 5},
+                {OP_PLA, 0x8, 4},{OP_ADC, 0x9, 2},{OP_ROR, 0xa, 2},{OP_ARR, 0x9, 2},{OP_JMP, 0x2d, 5},{OP_ADC, 0xd, 4},{OP_ROR, 0xd, 6},{OP_RRA, 0xd, 6},
 
-                {&BVS, 0x0, 2},{&ADC, 0x11, 5},{&JAM, 0x8, 1},{&RRA, 0x11, 8},{&NOP, 0x15, 4},{&ADC, 0x15, 4},{&ROR, 0x15, 6},{&RRA, 0x15, 6},
-                {&SEI, 0x8, 2},{&ADC, 0x19, 4},{&NOP, 0x8, 2},{&RRA, 0x19, 7},{&NOP, 0x1d, 4}, {&ADC, 0x1d, 4},{&ROR, 0x1d, 7},{&NOP, 0x1d, 7},
+                {OP_BVS, 0x0, 2},{OP_ADC, 0x11, 5},{OP_JAM, 0x8, 1},{OP_RRA, 0x11, 8},{OP_NOP, 0x15, 4},{OP_ADC, 0x15, 4},{OP_ROR, 0x15, 6},{OP_RRA, 0x15, 6},
+                {OP_SEI, 0x8, 2},{OP_ADC, 0x19, 4},{OP_NOP, 0x8, 2},{OP_RRA, 0x19, 7},{OP_NOP, 0x1d, 4}, {OP_ADC, 0x1d, 4},{OP_ROR, 0x1d, 7},{OP_NOP, 0x1d, 7},
 
-                {&NOP, 0x9, 2},{&STA, 0x1, 6},{&JAM, 0x9, 2},{&SAX, 0x11, 6},{&STY, 0x5, 3},{&STA, 0x5, 3},{&STX, 0x5, 3},{&SAX, 0x5, 3},
-                {&DEY, 0x8, 2},{&NOP, 0x9, 2},{&TXA, 0x8, 2},{&NOP, 0x8, 1},{&STY, 0xd, 4},{&STA, 0xd, 4},{&STX, 0xd, 4},{&SAX, 0xd, 4},
+                {OP_NOP, 0x9, 2},{OP_STA, 0x1, 6},{OP_JAM, 0x9, 2},{OP_SAX, 0x11, 6},{OP_STY, 0x5, 3},{OP_STA, 0x5, 3},{OP_STX, 0x5, 3},{OP_SAX, 0x5, 3},
+                {OP_DEY, 0x8, 2},{OP_NOP, 0x9, 2},{OP_TXA, 0x8, 2},{OP_NOP, 0x8, 1},{OP_STY, 0xd, 4},{OP_STA, 0xd, 4},{OP_STX, 0xd, 4},{OP_SAX, 0xd, 4},
 
-                {&BCC, 0x0, 2},{&STA, 0x11, 6},{&JAM, 0x8, 1},{&NOP, 0x8, 1},{&STY, 0x15, 4},{&STA, 0x15, 4},{&STX, 0x6, 4},{&SAX, 0x15, 4},
-                {&TYA, 0x8, 2},{&STA, 0x19, 5},{&TXS, 0x8, 2},{&NOP, 0x8, 1},{&NOP, 0x8, 1},{&STA, 0x1d, 5},{&NOP, 0x8, 1},{&NOP, 0x8, 1},
+                {OP_BCC, 0x0, 2},{OP_STA, 0x11, 6},{OP_JAM, 0x8, 1},{OP_NOP, 0x8, 1},{OP_STY, 0x15, 4},{OP_STA, 0x15, 4},{OP_STX, 0x6, 4},{OP_SAX, 0x15, 4},
+                {OP_TYA, 0x8, 2},{OP_STA, 0x19, 5},{OP_TXS, 0x8, 2},{OP_NOP, 0x8, 1},{OP_NOP, 0x8, 1},{OP_STA, 0x1d, 5},{OP_NOP, 0x8, 1},{OP_NOP, 0x8, 1},
 
-                {&LDY, 0x9, 2},{&LDA, 0x1, 6},{&LDX, 0x9, 2},{&LAX, 0x1, 6},{&LDY, 0x5, 3},{&LDA, 0x5, 3},{&LDX, 0x5, 3},{&LAX, 0x5, 3},
-                {&TAY, 0x8, 2},{&LDA, 0x9, 2},{&TAX, 0x8, 2},{&NOP, 0x8, 1},{&LDY, 0xd, 4},{&LDA, 0xd, 4},{&LDX, 0xd, 4},{&LAX, 0xd, 4},
+                {OP_LDY, 0x9, 2},{OP_LDA, 0x1, 6},{OP_LDX, 0x9, 2},{OP_LAX, 0x1, 6},{OP_LDY, 0x5, 3},{OP_LDA, 0x5, 3},{OP_LDX, 0x5, 3},{OP_LAX, 0x5, 3},
+                {OP_TAY, 0x8, 2},{OP_LDA, 0x9, 2},{OP_TAX, 0x8, 2},{OP_NOP, 0x8, 1},{OP_LDY, 0xd, 4},{OP_LDA, 0xd, 4},{OP_LDX, 0xd, 4},{OP_LAX, 0xd, 4},
 
-                {&BCS, 0x0, 2},{&LDA, 0x11, 5},{&JAM, 0x8, 1},{&LAX, 0x11, 5},{&LDY, 0x15, 4},{&LDA, 0x15, 4},{&LDX, 0x6, 4},{&LAX, 0x6, 4},
-                {&CLV, 0x8, 2},{&LDA, 0x19, 4},{&TSX, 0x8, 2},{&LAS, 0x19, 4},{&LDY, 0x1d, 4},{&LDA, 0x1d, 4},{&LDX, 0x19, 4},{&LAX, 0x19, 4},
+                {OP_BCS, 0x0, 2},{OP_LDA, 0x11, 5},{OP_JAM, 0x8, 1},{OP_LAX, 0x11, 5},{OP_LDY, 0x15, 4},{OP_LDA, 0x15, 4},{OP_LDX, 0x6, 4},{OP_LAX, 0x6, 4},
+                {OP_CLV, 0x8, 2},{OP_LDA, 0x19, 4},{OP_TSX, 0x8, 2},{OP_LAS, 0x19, 4},{OP_LDY, 0x1d, 4},{OP_LDA, 0x1d, 4},{OP_LDX, 0x19, 4},{OP_LAX, 0x19, 4},
 
-                {&CPY, 0x9, 2},{&CMP, 0x1, 6},{&JAM, 0x9, 2},{&DCP, 0x1, 8},{&CPY, 0x5, 3},{&CMP, 0x5, 3},{&DEC, 0x5, 5},{&DCP, 0x5, 5},
-                {&INY, 0x8, 2},{&CMP, 0x9, 2},{&DEX, 0x8, 2},{&SBX, 0x9, 2},{&CPY, 0xd, 4},{&CMP, 0xd, 4},{&DEC, 0xd, 6},{&DCP, 0xd, 6},
+                {OP_CPY, 0x9, 2},{OP_CMP, 0x1, 6},{OP_JAM, 0x9, 2},{OP_DCP, 0x1, 8},{OP_CPY, 0x5, 3},{OP_CMP, 0x5, 3},{OP_DEC, 0x5, 5},{OP_DCP, 0x5, 5},
+                {OP_INY, 0x8, 2},{OP_CMP, 0x9, 2},{OP_DEX, 0x8, 2},{OP_SBX, 0x9, 2},{OP_CPY, 0xd, 4},{OP_CMP, 0xd, 4},{OP_DEC, 0xd, 6},{OP_DCP, 0xd, 6},
 
-                {&BNE, 0x0, 2},{&CMP, 0x11, 5},{&JAM, 0x8, 1},{&DCP, 0x11, 8},{&NOP, 0x15, 4},{&CMP, 0x15, 4},{&DEC, 0x15, 6},{&DCP, 0x15, 6},
-                {&CLD, 0x8, 2},{&CMP, 0x19, 4},{&NOP, 0x8, 2},{&DCP, 0x19, 7},{&NOP, 0x1d, 4},{&CMP, 0x1d, 4},{&DEC, 0x1d, 7},{&DCP, 0x1d, 7},
+                {OP_BNE, 0x0, 2},{OP_CMP, 0x11, 5},{OP_JAM, 0x8, 1},{OP_DCP, 0x11, 8},{OP_NOP, 0x15, 4},{OP_CMP, 0x15, 4},{OP_DEC, 0x15, 6},{OP_DCP, 0x15, 6},
+                {OP_CLD, 0x8, 2},{OP_CMP, 0x19, 4},{OP_NOP, 0x8, 2},{OP_DCP, 0x19, 7},{OP_NOP, 0x1d, 4},{OP_CMP, 0x1d, 4},{OP_DEC, 0x1d, 7},{OP_DCP, 0x1d, 7},
 
-                {&CPX, 0x9, 2},{&SBC, 0x1, 6},{&NOP, 0x9, 2},{&ISC, 0x1, 8},{&CPX, 0x5, 3},{&SBC, 0x5, 3},{&INC, 0x5, 5},{&ISC, 0x5, 5},
-                {&INX, 0x8, 2},{&SBC, 0x9, 2},{&NOP, 0x8, 2},{&USBC, 0x9, 2},{&CPX, 0xd, 4},{&SBC, 0xd, 4},{&INC, 0xd, 6},{&ISC, 0xd, 6},
+                {OP_CPX, 0x9, 2},{OP_SBC, 0x1, 6},{OP_NOP, 0x9, 2},{OP_ISC, 0x1, 8},{OP_CPX, 0x5, 3},{OP_SBC, 0x5, 3},{OP_INC, 0x5, 5},{OP_ISC, 0x5, 5},
+                {OP_INX, 0x8, 2},{OP_SBC, 0x9, 2},{OP_NOP, 0x8, 2},{OP_USBC, 0x9, 2},{OP_CPX, 0xd, 4},{OP_SBC, 0xd, 4},{OP_INC, 0xd, 6},{OP_ISC, 0xd, 6},
 
-                {&BEQ, 0x0, 2},{&SBC, 0x11, 5},{&JAM, 0x8, 1},{&ISC, 0x11, 8},{&NOP, 0x15, 4},{&SBC, 0x15, 4},{&INC, 0x15, 6},{&ISC, 0x15, 6},
-                {&SED, 0x8, 2},{&SBC, 0x19, 4},{&NOP, 0x8, 2},{&ISC, 0x19, 7},{&NOP, 0x1d, 4},{&SBC, 0x1d, 4},{&INC, 0x1d, 7},{&ISC, 0x1d, 7}
+                {OP_BEQ, 0x0, 2},{OP_SBC, 0x11, 5},{OP_JAM, 0x8, 1},{OP_ISC, 0x11, 8},{OP_NOP, 0x15, 4},{OP_SBC, 0x15, 4},{OP_INC, 0x15, 6},{OP_ISC, 0x15, 6},
+                {OP_SED, 0x8, 2},{OP_SBC, 0x19, 4},{OP_NOP, 0x8, 2},{OP_ISC, 0x19, 7},{OP_NOP, 0x1d, 4},{OP_SBC, 0x1d, 4},{OP_INC, 0x1d, 7},{OP_ISC, 0x1d, 7}
 };
 
 /* Variablen for Communication with functions for opcodes */
@@ -89,81 +97,322 @@ uint8_t defs;
 uint8_t uses;
 uint8_t usedRegisters;
 uint8_t optimization;
-void (*used_helper_functions[9])(void) = {NULL};
+//length of output queue of generated code (run-ahead, power of two), 0 == output waits for its time
+uint8_t output_queue;
+//1 == WCET, 0 == BCET used for synchronisation
+uint8_t wcet;
 uint16_t cycles;
+//cycles of taken path of conditional branch, set for backend
+uint16_t cycles_taken;
 
-extern uint16_t parameter;
-extern uint8_t bytes;
+//set by addressing mode of representation
+uint16_t parameter;
+uint8_t bytes;
 //extern int dynamic;
 uint8_t bcd;
-extern uint16_t rom_addr;
-extern uint16_t rriot_addr;
-extern uint16_t jsr_counter;
-extern uint16_t jsr[2048];
+
+/* representations linked into translator, backend is the one currently analysed or printed */
+#define NUMBER_OF_BACKENDS 2
+Backend *backends[NUMBER_OF_BACKENDS] = {&c_backend, &avr_backend};
+Backend *backend;
 /* Functions for analysing loaded binary */
 
+/* registers of 6502 (LiveSet.registers) */
+enum{
+	REG_A = (1 << 0),
+	REG_X = (1 << 1),
+	REG_Y = (1 << 2),
+	REG_S = (1 << 3)
+};
+#define ALL_REGISTERS 0x0f
+#define ZERO_PAGE_BYTES (256 / 8)
+
+/* flags, registers and zero page bytes used, defined or live */
+typedef struct{
+	//flags (CF ... NF)
+	uint8_t flags;
+	//registers (REG_A ... REG_S)
+	uint8_t registers;
+	//zero page, address a is bit (a & 7) of zero_page[a >> 3]
+	uint8_t zero_page[ZERO_PAGE_BYTES];
+} LiveSet;
+
 typedef struct{
 	//start address
 	uint16_t start;
 	//end address
 	uint16_t end;
-	//cycles
+	//cycles (BCET)
 	int cycles;
+	//additional cycles for WCET (indexed reads crossing page boundary)
+	int penalty;
 	//instructions
 	int instructions;
-	//Gen (used flags) for flag optimization
-	uint8_t gen;
-       	//Kill (defined flags) for flag optimization
-	uint8_t kill;
-	//uses per instruction
-	uint8_t uses[32];
-	//defs per instruction
-	uint8_t defs[32];
+	//index of first instruction in instructions list
+	int first_instruction;
+	//live at begin and end of block (result of liveness analysis)
+	LiveSet live_in;
+	LiveSet live_out;
 }CodeBlock;
 
-//stuff in RAM treaten differently
-CodeBlock codeblocks[ROM_SIZE];
-uint16_t codeBlockCapacity;
-uint16_t startBlock;
-uint16_t endBlock;
+//block table covers the whole address space, so code in RAM and RRIOT ROM can be translated too
+CodeBlock codeblocks[MEMORY];
 
 uint16_t
 resolve_address_to_index_in_codeblocks(uint16_t address){
-	//check if address is in ROM or RRIOT ROM
-	if((address <= MAX_ROM) && (address >= MIN_ROM)){
-		//address in ROM
-		return address ^ MIN_ROM;
+	return address;
+}
+
+/* Functions for memory map */
+
+void
+apply_memory_map(void){
+	memset(region_kind, REGION_NONE, sizeof(region_kind));
+	for(int i = 0; i < number_of_regions; i++){
+		for(int address = memory_map[i].start; address <= memory_map[i].end; address++){
+			region_kind[address] = memory_map[i].kind;
+		}
+	}
+}
+
+uint8_t
+get_memory_region(uint16_t address){
+	return region_kind[address];
+}
+
+void
+index_memory_regions(void){
+	memset(region_size, 0, sizeof(region_size));
+	for(int address = 0; address < MEMORY; address++){
+		uint8_t kind = region_kind[address];
+		region_index[address] = region_size[kind];
+		region_size[kind]++;
+	}
+	for(int address = 0x0100; address <= 0x01ff; address++){
+		if(region_kind[address] != REGION_RAM){
+			fprintf(stderr, "warning: stack 0100 - 01ff is not RAM in memory map\n");
+			break;
+		}
+	}
+}
+
+uint16_t
+get_region_index(uint16_t address){
+	return region_index[address];
+}
+
+int
+get_region_size(uint8_t kind){
+	return region_size[kind];
+}
+
+uint8_t
+is_in_rom_region(uint16_t address){
+	uint8_t kind = region_kind[address];
+	return (kind == REGION_ROM) || (kind == REGION_RRIOT_ROM) || (kind == REGION_DATA);
+}
+
+/* reads memory map file, every line declares one region: <kind> <first address> <last address>
+ * e.g. "ROM e000 ffff", kinds are RAM, IO, RRIOT_RAM, RRIOT_ROM, ROM and DATA, # starts a comment */
+void
+load_memory_map(char *filename){
+	const char *kinds[] = {"NONE", "RAM", "IO", "RRIOT_RAM", "RRIOT_ROM", "ROM", "DATA"};
+	char line[128];
+	char kind[16];
+	unsigned int start;
+	unsigned int end;
+
+	FILE *file = fopen(filename, "r");
+	if(file == NULL){ perror("fopen"); exit(1); }
+	number_of_regions = 0;
+	while(fgets(line, sizeof(line), file) != NULL){
+		if((line[0] == '#') || (sscanf(line, "%15s", kind) != 1)){
+			//comment or empty line
+			continue;
+		}
+		if((sscanf(line, "%15s %x %x", kind, &start, &end) != 3) || (start > end) || (end >= MEMORY)){
+			fprintf(stderr, "invalid region in memory map: %s", line);
+			exit(1);
+		}
+		if(number_of_regions == MAX_REGIONS){
+			fprintf(stderr, "too many regions in memory map\n");
+			exit(1);
+		}
+		int k;
+		for(k = REGION_RAM; k <= REGION_DATA; k++){
+			if(strcmp(kind, kinds[k]) == 0){
+				break;
+			}
+		}
+		if(k > REGION_DATA){
+			fprintf(stderr, "unknown kind of region in memory map: %s\n", kind);
+			exit(1);
+		}
+		memory_map[number_of_regions].start = start;
+		memory_map[number_of_regions].end = end;
+		memory_map[number_of_regions].kind = k;
+		number_of_regions++;
+	}
+	fclose(file);
+}
+
+/* first and last address of loaded image */
+int image_start;
+int image_end;
+
+/* addresses of loaded image which are not declared by memory map are ROM */
+void
+map_image(int offset, int size){
+	image_start = offset;
+	image_end = offset + size - 1;
+	for(int address = offset; (address < offset + size) && (address < MEMORY); address++){
+		if(region_kind[address] == REGION_NONE){
+			region_kind[address] = REGION_ROM;
+		}
 	}
-	return -1;
 }
 
+/* attribute map of the address space: bitset per address plus index of leader and decoded instruction,
+ * so all lookups by address are O(1) */
+uint8_t address_attributes[MEMORY];
+uint16_t leader_index[MEMORY];
+uint16_t instruction_index[MEMORY];
+
+/* instructions decoded once in address order, basic blocks are ranges of this list */
+#define MAX_INSTRUCTIONS MEMORY
+BinaryInstruction instructions[MAX_INSTRUCTIONS];
+int number_of_instructions;
+
 //identify leaders: leader == Label or first instruction of code block
-uint16_t leader_addresses[2048];
+uint16_t leader_addresses[MAX_INSTRUCTIONS];
 int number_of_leaders;
 
 //basic block ends with jump or branch or IO or next leader
-uint16_t basicblock_startaddresses[2048];
+uint16_t basicblock_startaddresses[MAX_INSTRUCTIONS];
 int number_of_basicblocks;
 
-uint16_t io_operations[2048];
+uint16_t io_operations[MAX_INSTRUCTIONS];
 int IOops;
 
 uint16_t dynamic_targets[RAM_SIZE];
 int dynamicTargetAmount;
 
-//direction [from] -> [to]
-uint8_t adjacencyMatrix[ROM_SIZE][ROM_SIZE] = {{0, 0}}; 
+/* control flow graph: every block has at most two successors (branch target and fall-through),
+ * so edges are collected in a list and compressed into successor and predecessor arrays (CSR) */
+#define MAX_EDGES 2 * MEMORY
+
+/* kinds of edges: control leaves the source block by its last instruction */
+enum{
+	EDGE_FALLTHROUGH,	//conditional branch not taken or next instruction
+	EDGE_TAKEN,		//conditional branch taken, target on same page
+	EDGE_TAKEN_PAGE,	//conditional branch taken, target on other page
+	EDGE_JUMP,		//JMP or JSR to target
+	EDGE_RETURN		//JSR to instruction after JSR (return of subroutine by RTS)
+};
+
+typedef struct{
+	//index of source block in codeblocks
+	uint16_t from;
+	//index of target block in codeblocks
+	uint16_t to;
+	//kind of edge
+	uint8_t kind;
+	//cycles spent in addition to the cycles of the source block if edge is taken
+	uint8_t cycles;
+}Edge;
+
+Edge edges[MAX_EDGES];
+int number_of_edges;
+
+//successors of block i: successors[successor_start[i]] ... successors[successor_start[i+1] - 1]
+int successor_start[MEMORY + 1];
+uint16_t successors[MAX_EDGES];
+//kind and cycles of edge to successors[j]
+uint8_t successor_kinds[MAX_EDGES];
+uint8_t successor_cycles[MAX_EDGES];
+//predecessors of block i: predecessors[predecessor_start[i]] ... predecessors[predecessor_start[i+1] - 1]
+int predecessor_start[MEMORY + 1];
+uint16_t predecessors[MAX_EDGES];
+
+/* cycles of an edge: a taken branch needs one cycle more than a branch not taken, 
+ * two more if the target is on another page than the instruction following the branch.
+ * JMP, JSR and RTS need the same cycles on every path, they are part of the blocks */
+uint8_t
+get_edge_cycles(uint8_t kind){
+	if(kind == EDGE_TAKEN){
+		return 1;
+	}else if(kind == EDGE_TAKEN_PAGE){
+		return 2;
+	}
+	return 0;
+}
+
+void
+add_edge(uint16_t from, uint16_t to, uint8_t kind){
+	//edges of one block are added one after another, so only the tail of the list has to be checked.
+	//A branch to the next instruction has two edges to the same block with different cycles
+	for(int i = number_of_edges - 1; (i >= 0) && (edges[i].from == from); i--){
+		if((edges[i].to == to) && (edges[i].kind == kind)){
+			return;
+		}
+	}
+	if(number_of_edges == MAX_EDGES){
+		fprintf(stderr, "too many edges in control flow graph\n");
+		exit(1);
+	}
+	edges[number_of_edges].from = from;
+	edges[number_of_edges].to = to;
+	edges[number_of_edges].kind = kind;
+	edges[number_of_edges].cycles = get_edge_cycles(kind);
+	number_of_edges++;
+}
+
+/* compresses edge list to successor and predecessor arrays (counting sort by block index) */
+void
+build_cfg(void){
+	memset(successor_start, 0, sizeof(successor_start));
+	memset(predecessor_start, 0, sizeof(predecessor_start));
+
+	for(int i = 0; i < number_of_edges; i++){
+		successor_start[edges[i].from + 1]++;
+		predecessor_start[edges[i].to + 1]++;
+	}
+	for(int i = 0; i < MEMORY; i++){
+		successor_start[i + 1] += successor_start[i];
+		predecessor_start[i + 1] += predecessor_start[i];
+	}
+
+	static int next_successor[MEMORY];
+	static int next_predecessor[MEMORY];
+	memcpy(next_successor, successor_start, sizeof(next_successor));
+	memcpy(next_predecessor, predecessor_start, sizeof(next_predecessor));
+	for(int i = 0; i < number_of_edges; i++){
+		int j = next_successor[edges[i].from]++;
+		successors[j] = edges[i].to;
+		successor_kinds[j] = edges[i].kind;
+		successor_cycles[j] = edges[i].cycles;
+		predecessors[next_predecessor[edges[i].to]++] = edges[i].from;
+	}
+}
 
 int
 is_leader(uint16_t address){
-        for(int i = 0; i < number_of_leaders; i++){
-                if(leader_addresses[i] == address){
-                        return i;
-                }
-        }
+	if(address_attributes[address] & ATTR_LEADER){
+		return leader_index[address];
+	}
         return -1;
 }
 
+void
+add_leader(uint16_t address){
+	if(is_leader(address) == -1){
+		leader_index[address] = number_of_leaders;
+		address_attributes[address] |= ATTR_LEADER;
+		leader_addresses[number_of_leaders] = address;
+		number_of_leaders++;
+	}
+}
+
 int is_branch_instruction(uint8_t opcode){
         if((opcode & 0xf) == 0){
                 uint8_t hi = opcode >> 4;
@@ -179,31 +428,42 @@ is_jump(uint8_t opcode){
 	return (opcode == 0x4C) || (opcode == 0x6C) || (opcode == 0x20);
 }
 
+/* reading instructions with absolute indexed or indirect indexed addressing need one cycle more
+ * if the effective address is on another page than the base address */
+uint8_t
+has_page_cross_penalty(BinaryInstruction *instruction){
+	uint8_t mode = code[instruction->opcode].addressingMode;
+	switch(code[instruction->opcode].mnemonic){
+		case OP_ADC: case OP_AND: case OP_CMP: case OP_EOR: case OP_LDA: case OP_LDX:
+		case OP_LDY: case OP_ORA: case OP_SBC: case OP_LAX: case OP_LAS: case OP_NOP:
+			break;
+		default:
+			//stores and read-modify-write instructions always need the same cycles
+			return 0;
+	}
+	if((mode == 0x1d) || (mode == 0x19)){
+		//index added to base address on first byte of page never crosses page boundary
+		return (instruction->operand & 0xff) != 0;
+	}
+	//pointer in zero page is unknown
+	return mode == 0x11;
+}
+
 /* adds I/O Opertaios to a list of I/O Operations*/
 uint8_t
 is_in_io_operations(uint16_t address){
-        for(int i = 0; i < IOops; i++){
-                if(io_operations[i] == address){
-                        return 1;
-                }
-        }
-        return 0;
-
+        return (address_attributes[address] & ATTR_IO) != 0;
 }
 
 uint8_t
 check_if_IO_reachable(uint16_t address){
 	//IO Addresses can be rearched if difference between address without index and IO address space is representable as 8-Bit 2's complement value
-	int16_t requiredIndex;
-	if(address > MAX_IO){
-        	//2's complement could be used to reach IO addresses
-                requiredIndex = MAX_IO - address;
-	}else if(address < MIN_IO){
-		//IO addresses could be reached adding a positive 8 bit integer
-		requiredIndex = MIN_IO - address;
+	for(int index = -128; index <= 127; index++){
+		if(region_kind[(uint16_t) (address + index)] == REGION_IO){
+			return 1;
+		}
 	}
-	//check if difference is in range of 8-Bit 2's complement
-        return (requiredIndex >= -128) && (requiredIndex <= 127);
+	return 0;
 }
 
 uint8_t 
@@ -225,12 +485,12 @@ is_io_instruction(uint8_t opcode){
                 //only absolute possible or absolute with index
 		if(code[opcode].addressingMode == 0xd){
                 	address = m[pc+1] | ((uint16_t) m[pc+2] << 8);
-			return (address >= MIN_IO) && (address <= MAX_IO);
+			return region_kind[address] == REGION_IO;
 
                 }else if((code[opcode].addressingMode == 0x1d) || (code[opcode].addressingMode == 0x15)){
 			//addressing mode is indexed by register and can potentially reach IO addresses
 			address = m[pc+1] | ((uint16_t) m[pc+2] << 8);
-			return ((address >= MIN_IO) && (address <= MAX_IO)) || check_if_IO_reachable(address);
+			return check_if_IO_reachable(address);
 		}
         }
         return 0;
@@ -239,560 +499,3094 @@ is_io_instruction(uint8_t opcode){
 void
 add_io_instruction(uint16_t address){
 	if(!is_in_io_operations(address)){
+		address_attributes[address] |= ATTR_IO;
 		io_operations[IOops] = address;
         	IOops++;
 	}
 }
 
-void
-get_used_helperfunctions(uint8_t opcode){
-	toSet = DEFS;
-	(*code[opcode].opcode)();
-	toSet = BYTES;
+/* length of instruction by addressing mode */
+uint8_t
+get_instruction_length(uint8_t addressingMode){
+	switch(addressingMode){
+		case 0x8:
+		case 0xa:
+			//implied
+			return 1;
+		case 0xd:
+		case 0x1d:
+		case 0x19:
+		case 0x2d:
+			//absolute and indirect
+			return 3;
+	}
+	return 2;
 }
 
+/* decodes instruction at pc: operands, target and cycles
+ * (flags used and defined are set by analysis of representation, see prepare_backend) */
 void
-get_next_instruction(void){
-        toSet = BYTES;
-        call_corresponding_addressingMode(m[pc]);
-        pc += bytes;
-        toSet = IR;
+decode_instruction(BinaryInstruction *instruction){
+	uint8_t opcode = m[pc];
+
+	instruction->opcode = opcode;
+	instruction->address = pc;
+	instruction->bytes = get_instruction_length(code[opcode].addressingMode);
+	instruction->cycles = code[opcode].cycles;
+	instruction->operand = 0;
+	if(instruction->bytes == 2){
+		instruction->operand = m[pc + 1];
+	}else if(instruction->bytes == 3){
+		instruction->operand = m[pc + 1] | ((uint16_t) m[pc + 2] << 8);
+	}
+
+	if(is_branch_instruction(opcode)){
+		//relative addressing: target relative to next instruction
+		instruction->parameter = pc + 2 + (int8_t) instruction->operand;
+	}else if(opcode == 0x6C){
+		//JMP indirect: target is read from vector
+		uint16_t vector = instruction->operand;
+		instruction->parameter = m[vector] | ((uint16_t) m[(uint16_t) (vector + 1)] << 8);
+	}else{
+		instruction->parameter = instruction->operand;
+	}
+
+	instruction->uses = 0;
+	instruction->defs = 0;
 }
 
 /* add leaders of hyperblocks to leader_address list and complete adjacent list*/
 void
-add_branch_and_leader(uint16_t branch, uint16_t leader){
+add_branch_and_leader(uint16_t leader){
 
 	uint16_t index = resolve_address_to_index_in_codeblocks(leader);	
 	codeblocks[index].start = leader;
-	if(is_leader(leader) == -1){
-		leader_addresses[number_of_leaders] = leader;
-		number_of_leaders++;
+	add_leader(leader);
+}
+
+/* Code discovery: control flow is followed from the vectors (recursive descent),
+ * only reachable bytes are code, everything else is data */
+#define NMI_VECTOR 0xfffa
+#define RESET_VECTOR 0xfffc
+#define IRQ_VECTOR 0xfffe
+
+//entry points of code which are not yet followed
+uint16_t trace_stack[MEMORY];
+int trace_top;
+
+uint8_t
+is_in_code_region(uint16_t address){
+	uint8_t kind = region_kind[address];
+	//last bytes are vectors
+	return ((kind == REGION_ROM) || (kind == REGION_RRIOT_ROM) || (kind == REGION_RAM)) && (address <= MEMORY - 3);
+}
+
+uint8_t
+is_instruction(uint16_t address){
+	return (address_attributes[address] & ATTR_INSTRUCTION) != 0;
+}
+
+/* JMP indirect with vector outside ROM: target is only known at runtime, the program stops there */
+uint8_t
+is_dynamic_jump(BinaryInstruction *instruction){
+	return (instruction->opcode == 0x6C) && !is_in_rom_region(instruction->operand);
+}
+
+/* control flow reaches an address inside a traced instruction (e.g. the BIT skip idiom): only one instruction
+ * stream is translated, the program stops at the other one like at BRK (see print_stop) */
+uint8_t stop_target[MEMORY];
+uint8_t stop_printed[MEMORY];
+
+uint8_t
+ends_control_flow(uint8_t opcode){
+	//RTS, RTI, BRK and JAM: execution does not continue with next instruction
+	return (opcode == 0x60) || (opcode == 0x40) || (opcode == 0x00) || (code[opcode].mnemonic == OP_JAM);
+}
+
+uint8_t
+falls_into_stop(BinaryInstruction *instruction){
+	uint8_t opcode = instruction->opcode;
+	return !ends_control_flow(opcode) && (opcode != 0x4C) && (opcode != 0x6C) && stop_target[(uint16_t) (instruction->address + instruction->bytes)];
+}
+
+uint8_t
+jumps_to_stop(BinaryInstruction *instruction){
+	uint8_t opcode = instruction->opcode;
+	return (is_branch_instruction(opcode) || is_jump(opcode)) && !is_dynamic_jump(instruction) && stop_target[instruction->parameter];
+}
+
+void
+add_code_entry(uint16_t address){
+	if(!is_in_code_region(address)){
+		fprintf(stderr, "target %x is not in a code region\n", address);
+		exit(1);
+	}
+	if(is_leader(address) == -1){
+		trace_stack[trace_top] = address;
+		trace_top++;
+	}
+	add_branch_and_leader(address);
+}
+
+/* follows control flow from address until jump, return or end of program and marks instructions */
+void
+trace_code(uint16_t address){
+	BinaryInstruction instruction;
+
+	while(!is_instruction(address)){
+		if(address_attributes[address] & ATTR_CODE){
+			fprintf(stderr, "warning: %x jumps into instruction, translated program stops there\n", address);
+			stop_target[address] = 1;
+			return;
+		}else if(!is_in_code_region(address)){
+			fprintf(stderr, "code at %x continues into data\n", address);
+			return;
+		}
+		pc = address;
+		decode_instruction(&instruction);
+		for(int i = 1; i < instruction.bytes; i++){
+			if(address_attributes[address + i] & ATTR_CODE){
+				fprintf(stderr, "warning: instruction at %x overlaps instruction, translated program stops there\n", address);
+				stop_target[address] = 1;
+				return;
+			}
+		}
+		for(int i = 1; i < instruction.bytes; i++){
+			address_attributes[address + i] |= ATTR_CODE;
+		}
+		address_attributes[address] |= ATTR_CODE | ATTR_INSTRUCTION;
+
+		uint8_t opcode = instruction.opcode;
+		if(is_branch_instruction(opcode)){
+			//contitional branch found
+			add_code_entry(instruction.parameter);
+		}else if(opcode == 0x6C){
+			//JMP indirect found
+			if(is_dynamic_jump(&instruction)){
+				fprintf(stderr, "warning: vector of JMP at %x is in RAM, translated program stops there\n", address);
+				return;
+			}
+			add_code_entry(instruction.parameter);
+			return;
+		}else if(opcode == 0x4C){
+			//JMP found
+			add_code_entry(instruction.parameter);
+			return;
+		}else if(opcode == 0x20){
+			//JSR found, execution continues after return
+			add_code_entry(instruction.parameter);
+			address_attributes[instruction.parameter] |= ATTR_JSR_TARGET;
+		}else if(ends_control_flow(opcode)){
+			return;
+		}
+		address += instruction.bytes;
 	}
 }
 
-/* Identifies Leaders of Hyperblocks */
+/* Identifies Leaders of Hyperblocks from reachable code, every instruction is decoded exactly once here */
 uint16_t
 find_leaders_and_branches(void){
-	pc = m[0xfffc] | ((uint16_t) m[0xfffd] << 8);
 	bcd = 0;
+	number_of_instructions = 0;
+	trace_top = 0;
+
+	//reset vector is entry of program, interrupt handlers are followed if image contains their vectors
+	pc = RESET_VECTOR;
+	add_code_entry(m[RESET_VECTOR] | ((uint16_t) m[RESET_VECTOR + 1] << 8));
+	if((image_start <= NMI_VECTOR) && (image_end >= NMI_VECTOR + 1)){
+		add_code_entry(m[NMI_VECTOR] | ((uint16_t) m[NMI_VECTOR + 1] << 8));
+	}
+	if((image_start <= IRQ_VECTOR) && (image_end >= IRQ_VECTOR + 1)){
+		add_code_entry(m[IRQ_VECTOR] | ((uint16_t) m[IRQ_VECTOR + 1] << 8));
+	}
+	while(trace_top > 0){
+		trace_top--;
+		trace_code(trace_stack[trace_top]);
+	}
 
-	//first address is also leader
-	uint16_t index = resolve_address_to_index_in_codeblocks(pc);
-        codeblocks[index].start = pc;
-	leader_addresses[number_of_leaders] = pc;
-        number_of_leaders++;
-	toSet = BYTES;
-
-	while(pc < MEMORY){
-		if(pc == END_PROGRAM){
-			//0xfffa, 0xfffb, 0xfffc, 0xfffd, 0xfffe, 0xffff are vectors
-			pc = IO_START;
-		}else if(pc == START_TABLE){
-			return pc;
+	//decode reachable instructions in address order
+	uint16_t last = 0;
+	for(int address = 0; address < MEMORY; address++){
+		if(!is_instruction(address)){
+			continue;
 		}
-		
-		uint8_t opcode = m[pc];
-		//resolve parameters and instruction length by calling Adressing Mode 
-		call_corresponding_addressingMode(opcode);
-                
-                if(is_branch_instruction(opcode)){
-			//contitional branch found
-			add_branch_and_leader(pc, parameter);
-		 }else if(opcode == 0x6C){
-                        //JMP indirect found
-                        uint16_t vector = m[pc + 1] | ((uint16_t) m[pc + 2]);
-                        if(((vector <= MAX_ROM) && (vector >= MIN_ROM)) || ((vector <= MAX_RRIOT_ROM) && (vector >= MIN_RRIOT_ROM))){
-                                //target is a leader
-                                add_branch_and_leader(pc, parameter);
-                        }else{
-                                //vector in RAM
-                                exit(1);
-                        }
-		}else if(is_jump(opcode)){
-			//JSR or JMP found
-                        add_branch_and_leader(pc, parameter);
-		} 
+		pc = address;
+		decode_instruction(&instructions[number_of_instructions]);
+		instruction_index[address] = number_of_instructions;
+		number_of_instructions++;
+		last = address;
+	}
+	fprintf(stderr, "%d reachable instructions\n", number_of_instructions);
+	return last;
+}
 
-		get_used_helperfunctions(opcode);
-		pc += bytes;
+uint8_t
+is_program_entry(uint16_t index){
+	uint16_t vectors[3] = {RESET_VECTOR, NMI_VECTOR, IRQ_VECTOR};
+	for(int v = 0; v < 3; v++){
+		if((v > 0) && ((image_start > vectors[v]) || (image_end < vectors[v] + 1))){
+			continue;
+		}
+		if(index == (m[vectors[v]] | ((uint16_t) m[vectors[v] + 1] << 8))){
+			return 1;
+		}
 	}
-	return pc;
+	return 0;
 }
 
 void
 add_basicBlock_to_basicblock_list(uint16_t address){
-	for(int i = 0; i < number_of_basicblocks; i++){
-		if(basicblock_startaddresses[i] == address){
-			return;
-		}
+	if(address_attributes[address] & ATTR_BASICBLOCK){
+		return;
 	}
+	address_attributes[address] |= ATTR_BASICBLOCK;
 	basicblock_startaddresses[number_of_basicblocks] = address;
 	number_of_basicblocks++;
 }
 
 uint16_t
-add_basicblock(uint16_t index, uint8_t opcode){
+add_basicblock(uint16_t index, BinaryInstruction *instruction){
 
 	codeblocks[index].end = pc;
 	uint16_t next = 0;
+	uint8_t opcode = instruction->opcode;
 
-	if(is_branch_instruction(opcode) || is_io_instruction(opcode)){
+	uint16_t following = pc + instruction->bytes;
+	if((is_branch_instruction(opcode) || is_io_instruction(opcode)) && is_instruction(following)){
 		//set arrow to next instruction
-		next = resolve_address_to_index_in_codeblocks(pc + bytes);
-		adjacencyMatrix[index][next] = 1;
+		next = resolve_address_to_index_in_codeblocks(following);
+		add_edge(index, next, EDGE_FALLTHROUGH);
 	}
 
-	if(is_branch_instruction(opcode) || is_jump(opcode)){
-		//get target and set arrow in adjecent matrix
-		next = resolve_address_to_index_in_codeblocks(parameter);
-		adjacencyMatrix[index][next] = 1;
+	if(is_branch_instruction(opcode)){
+		//get target and set arrow in control flow graph, page of target is compared with page of following instruction,
+		//no arrow to target inside an instruction (see stop_target)
+		next = resolve_address_to_index_in_codeblocks(instruction->parameter);
+		if(is_instruction(instruction->parameter)){
+			if((instruction->parameter & 0xff00) == (following & 0xff00)){
+				add_edge(index, next, EDGE_TAKEN);
+			}else{
+				add_edge(index, next, EDGE_TAKEN_PAGE);
+			}
+		}
+	}else if(is_jump(opcode) && !is_dynamic_jump(instruction) && is_instruction(instruction->parameter)){
+		next = resolve_address_to_index_in_codeblocks(instruction->parameter);
+		add_edge(index, next, EDGE_JUMP);
+		if((opcode == 0x20) && is_instruction(following)){
+			//subroutine returns to instruction after JSR
+			add_edge(index, resolve_address_to_index_in_codeblocks(following), EDGE_RETURN);
+		}
 	}
 
 	//change pc to start of next basic block
-	pc += bytes;
+	pc += instruction->bytes;
+	if(!is_instruction(pc)){
+		//no code after jump
+		return index;
+	}
 	//add new basic block to list
 	add_basicBlock_to_basicblock_list(pc);
 	
 	index = resolve_address_to_index_in_codeblocks(pc);
         codeblocks[index].start = pc;
+	codeblocks[index].first_instruction = instruction_index[pc];
 	return index;
 }
 
 void
 complete_block(void){
-	uint16_t start = m[0xfffc] | ((uint16_t) m[0xfffd] << 8);
-        uint16_t old_pc = start;
-	toSet = BYTES;
+        uint16_t old_pc = 0;
 	number_of_basicblocks = 0;
 
-	//init variables for control flow graph
-	startBlock = start;
-	endBlock = start;
-
         for(int i = 0; i < number_of_leaders; i++){
 		pc = leader_addresses[i];
-		start = pc;
+		if(!is_instruction(pc)){
+			//target inside an instruction, see stop_target
+			continue;
+		}
 
 		int index = resolve_address_to_index_in_codeblocks(pc);
-		int old_index = index;
 
 		add_basicBlock_to_basicblock_list(pc);
                 codeblocks[index].start = pc;
+		codeblocks[index].first_instruction = instruction_index[pc];
+		//block contains instructions which are not yet terminated by branch, jump or IO
+		uint8_t block_open = 0;
 		goto next;
 		
-		while(is_leader(pc) == -1){
+		while((is_leader(pc) == -1) && is_instruction(pc)){
 next:
 			old_pc = pc;
-			if(index != old_index){
-				if(pc >= endBlock){
-                 		       endBlock = pc;
-                		}
-				old_index = index;
-			}
+			block_open = 1;
 
-			uint8_t opcode = m[pc];
-                        codeblocks[index].cycles += code[opcode].cycles;
+			BinaryInstruction *instruction = &instructions[instruction_index[pc]];
+			uint8_t opcode = instruction->opcode;
+                        codeblocks[index].cycles += instruction->cycles;
                         codeblocks[index].instructions++;	
-			
-			call_corresponding_addressingMode(opcode);
+
+			if(has_page_cross_penalty(instruction)){
+				//indexed read may cross page boundary, added if WCET is used
+				codeblocks[index].penalty += 1;
+			}
 
 			if(is_branch_instruction(opcode)){
-				//add penality for branch taken and crossing page boundary
-#if WCET
-				if((parameter & 0xff00) == (pc & 0xff00)){
-					//page boundary not crossed
-					codeblocks[index].cycles += 1;
-				}else{
-					//page boundary crossed
-					codeblocks[index].cycles += 2;
-				}
-#endif
-				index = add_basicblock(index, opcode);
+				//cycles of taken branch are cycles of edge to target
+				index = add_basicblock(index, instruction);
+				block_open = 0;
 				continue;
 			}else if(is_io_instruction(opcode)){
 				add_io_instruction(pc);
-				index = add_basicblock(index, opcode);
+				index = add_basicblock(index, instruction);
+				block_open = 0;
 				continue;
 			}else if(is_jump(opcode)){
-				index = add_basicblock(index, opcode);
+				index = add_basicblock(index, instruction);
+				block_open = 0;
 				continue;
-			}else if((opcode == 0x00) && (m[pc+1] == 0)){
+			}else if(ends_control_flow(opcode)){
+				//program end, return from subroutine or interrupt: no successor in control flow graph
                                 break;
 			}else{
-				pc += bytes;
+				pc += instruction->bytes;
 			}
 		}
+		if(!block_open){
+			//block already terminated, next leader starts its own block
+			continue;
+		}
 		codeblocks[index].end = old_pc;
-		
-		adjacencyMatrix[index][resolve_address_to_index_in_codeblocks(pc)] = 1;
-		
+
+		if((pc != old_pc) && is_instruction(pc)){
+			//block falls through to next leader
+			add_edge(index, resolve_address_to_index_in_codeblocks(pc), EDGE_FALLTHROUGH);
+		}
 	}
+	build_cfg();
 }
 
-/* Code for Optimization */
-void
-analyse_uses_and_defs_code_block(void){
-	toSet = DEFS;
-	uint8_t used_registers = 0;
-
-        for(int i = 0; i < number_of_basicblocks; i++){
-		pc = basicblock_startaddresses[i];
-		
-		if(pc == END_PROGRAM){
-                        //0xfffa, 0xfffb, 0xfffc, 0xfffd, 0xfffe, 0xffff are vectors
-                        continue;
-                }else if(pc == START_TABLE){
-                        continue;
-                }
-
-		uint16_t index = resolve_address_to_index_in_codeblocks(pc);
-		
-		for(int j = 0; j < codeblocks[index].instructions; j++){
-                        (*code[m[pc]].opcode)();
-                        codeblocks[index].uses[j] = uses;
-                        codeblocks[index].defs[j] = defs;
-
-			used_registers |= usedRegisters;
-			usedRegisters = 0;
-
-			toSet = BYTES;
-		        call_corresponding_addressingMode(m[pc]);
-        		pc += bytes;
-			toSet = DEFS;
-
-                }
-
-		for(int j = codeblocks[index].instructions - 1; j >= 0; j--){
-                        //backwards: calculating gen and kill 
-                        codeblocks[index].gen = codeblocks[index].uses[j] | (codeblocks[index].gen & ~(codeblocks[index].defs[j]));
-                        //Kill
-                        codeblocks[index].kill = codeblocks[index].defs[j] | codeblocks[index].kill;
-                }
+/* condition of branch instruction known by constant propagation (propagate_constants) */
+enum{
+	BRANCH_UNKNOWN = 0,
+	BRANCH_NEVER_TAKEN,
+	BRANCH_ALWAYS_TAKEN
+};
 
-	}
-	usedRegisters = used_registers;
-}
+uint8_t branch_outcome[MEMORY];
 
-uint8_t changed;
+/* Analysis of representation: flags used and defined, helper functions, subroutine calls, ROM tables for
+ * indexed access and registers. Flags used and defined are the same for every representation,
+ * so one prepared representation is enough for the optimization */
+uint8_t backend_prepared[NUMBER_OF_BACKENDS];
+uint8_t backend_registers[NUMBER_OF_BACKENDS];
 
 void
-compute_LV(int index, uint8_t checked[], int checked_blocks){
-	uint16_t queue[number_of_basicblocks];
-	uint8_t succs[number_of_basicblocks-1];
-        int next = 0;
-	int successors = 0;
+prepare_backend(int b){
+	static uint8_t registers[MAX_INSTRUCTIONS];
 
-	//get previous code blocks and successors by checking Adjacency Matrix
-	for(int i = startBlock; i <= endBlock; i++){
-        	uint16_t candidate = resolve_address_to_index_in_codeblocks(i);
-               	if(adjacencyMatrix[candidate][index] == 1){
-               		queue[next] = candidate;
-                       	next++;
-               	}
-		if(adjacencyMatrix[index][candidate] == 1){
-			succs[successors] = candidate;
-			successors++;
+	backend = backends[b];
+	if(backend_prepared[b]){
+		return;
+	}
+	for(int i = 0; i < number_of_instructions; i++){
+		pc = instructions[i].address;
+		uint8_t opcode = instructions[i].opcode;
+
+		toSet = BYTES;
+		(*backend->addressing_mode)(opcode);
+		uses = 0;
+		defs = 0;
+		usedRegisters = 0;
+		toSet = DEFS;
+		(*backend->opcodes[code[opcode].mnemonic])();
+		if(branch_outcome[pc] != BRANCH_UNKNOWN){
+			//flags are not tested by branch with known condition (propagate_constants)
+			uses = 0;
 		}
-        }
+		instructions[i].uses = uses;
+		instructions[i].defs = defs;
+		registers[i] = usedRegisters;
+	}
 
-	//apply Formula wcre_02, S. 5
-        uint8_t lv = 0;
-        for(int i = 0; i < successors; i++){
-                //U_{s elem succ(u)} LV(s)
-                lv |= codeblocks[succs[i]].gen;
-        }
-        //(Gen_{succs}-def(u)) u uses(u)
-	uint8_t temp = codeblocks[index].gen;
-        codeblocks[index].gen |= (lv & ~(codeblocks[index].kill));
-	if(temp != codeblocks[index].gen){
-		//result not stabel
-		changed = 1;
-	}
- 	//continue with next block
-	if(codeblocks[index].start == startBlock){
-		//Abbruch Rekursion
-		return;
-	}else{
-		checked[checked_blocks] = index;
-		checked_blocks++;
-		int seen = 0;
-		//continue to compute others
-		for(int i = 0; i < next; i++){
-			for(int j = 0; j < checked_blocks; j++){
-				if(queue[i] == checked[j]){
-					seen = 1;
-					break;
-				}
-			}
-			if(!seen){
-				compute_LV(queue[i], checked, checked_blocks);
-			}
+	//only registers of instructions in basic blocks are declared
+	usedRegisters = 0;
+	for(int i = 0; i < number_of_basicblocks; i++){
+		uint16_t index = resolve_address_to_index_in_codeblocks(basicblock_startaddresses[i]);
+		if(region_kind[index] == REGION_DATA){
+			continue;
+		}
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			usedRegisters |= registers[codeblocks[index].first_instruction + j];
 		}
 	}
+	backend_registers[b] = usedRegisters;
+	backend_prepared[b] = 1;
 }
 
-void
-compute_optimization(void){
-	uint8_t checked[number_of_basicblocks];
-	int checked_blocks = 0;
+/* Code for Optimization */
+#define ALL_FLAGS 0xff
+
+/* access of instruction to its memory operand */
+enum{
+	MEM_NONE = 0,
+	MEM_READ,
+	MEM_WRITE,
+	MEM_MODIFY
+};
 
-	changed = 1;
-	while(changed != 0){
-		changed = 0;
-		compute_LV(resolve_address_to_index_in_codeblocks(endBlock), checked, checked_blocks);
-	}
-}
+struct Effects{
+	//registers used and defined (REG_A ... REG_S), accumulator addressing adds REG_A
+	uint8_t uses;
+	uint8_t defs;
+	//access to memory operand
+	uint8_t memory;
+};
 
-/* Code for printing */
-uint8_t
-is_branch(uint16_t pc){
-	return is_branch_instruction(m[pc]) || is_jump(m[pc]);
+/* registers and memory operand of every mnemonic (index OP_ADC ... OP_JAM), memory of stack is not tracked */
+struct Effects effects[NUMBER_OF_MNEMONICS] = {
+	/* Instructions */
+	{REG_A, REG_A, MEM_READ},		//ADC
+	{REG_A, REG_A, MEM_READ},		//AND
+	{0, 0, MEM_MODIFY},			//ASL
+	{0, 0, MEM_NONE},			//BCC
+	{0, 0, MEM_NONE},			//BCS
+	{0, 0, MEM_NONE},			//BEQ
+	{REG_A, 0, MEM_READ},			//BIT
+	{0, 0, MEM_NONE},			//BMI
+	{0, 0, MEM_NONE},			//BNE
+	{0, 0, MEM_NONE},			//BPL
+	{0, 0, MEM_NONE},			//BRK ends the program, see live_at_exit
+	{0, 0, MEM_NONE},			//BVC
+	{0, 0, MEM_NONE},			//BVS
+	{0, 0, MEM_NONE},			//CLC
+	{0, 0, MEM_NONE},			//CLD
+	{0, 0, MEM_NONE},			//CLI
+	{0, 0, MEM_NONE},			//CLV
+	{REG_A, 0, MEM_READ},			//CMP
+	{REG_X, 0, MEM_READ},			//CPX
+	{REG_Y, 0, MEM_READ},			//CPY
+	{0, 0, MEM_MODIFY},			//DEC
+	{REG_X, REG_X, MEM_NONE},		//DEX
+	{REG_Y, REG_Y, MEM_NONE},		//DEY
+	{REG_A, REG_A, MEM_READ},		//EOR
+	{0, 0, MEM_MODIFY},			//INC
+	{REG_X, REG_X, MEM_NONE},		//INX
+	{REG_Y, REG_Y, MEM_NONE},		//INY
+	{0, 0, MEM_NONE},			//JMP
+	{REG_S, REG_S, MEM_NONE},		//JSR
+	{0, REG_A, MEM_READ},			//LDA
+	{0, REG_X, MEM_READ},			//LDX
+	{0, REG_Y, MEM_READ},			//LDY
+	{0, 0, MEM_MODIFY},			//LSR
+	{0, 0, MEM_NONE},			//NOP
+	{REG_A, REG_A, MEM_READ},		//ORA
+	{REG_A | REG_S, REG_S, MEM_NONE},	//PHA
+	{REG_S, REG_S, MEM_NONE},		//PHP
+	{REG_S, REG_A | REG_S, MEM_NONE},	//PLA
+	{REG_S, REG_S, MEM_NONE},		//PLP
+	{0, 0, MEM_MODIFY},			//ROL
+	{0, 0, MEM_MODIFY},			//ROR
+	{REG_S, REG_S, MEM_NONE},		//RTI
+	{REG_S, REG_S, MEM_NONE},		//RTS
+	{REG_A, REG_A, MEM_READ},		//SBC
+	{0, 0, MEM_NONE},			//SEC
+	{0, 0, MEM_NONE},			//SED
+	{0, 0, MEM_NONE},			//SEI
+	{REG_A, 0, MEM_WRITE},			//STA
+	{REG_X, 0, MEM_WRITE},			//STX
+	{REG_Y, 0, MEM_WRITE},			//STY
+	{REG_A, REG_X, MEM_NONE},		//TAX
+	{REG_A, REG_Y, MEM_NONE},		//TAY
+	{REG_S, REG_X, MEM_NONE},		//TSX
+	{REG_X, REG_A, MEM_NONE},		//TXA
+	{REG_X, REG_S, MEM_NONE},		//TXS
+	{REG_Y, REG_A, MEM_NONE},		//TYA
+	/* "Illegal" Opcodes */
+	{REG_A, REG_A, MEM_READ},		//ALR
+	{REG_A, REG_A, MEM_READ},		//ANC
+	{REG_A, REG_A, MEM_READ},		//ANC2
+	{REG_A, REG_A, MEM_READ},		//ARR
+	{REG_A, 0, MEM_MODIFY},			//DCP
+	{REG_A, REG_A, MEM_MODIFY},		//ISC
+	{REG_S, REG_A | REG_X | REG_S, MEM_READ},	//LAS
+	{0, REG_A | REG_X, MEM_READ},		//LAX
+	{REG_A, REG_A, MEM_MODIFY},		//RLA
+	{REG_A, REG_A, MEM_MODIFY},		//RRA
+	{REG_A | REG_X, 0, MEM_WRITE},		//SAX
+	{REG_A | REG_X, REG_X, MEM_READ},	//SBX
+	{REG_A, REG_A, MEM_MODIFY},		//SLO
+	{REG_A, REG_A, MEM_MODIFY},		//SRE
+	{REG_A, REG_A, MEM_READ},		//USBC
+	{ALL_REGISTERS, 0, MEM_NONE}		//JAM
+};
+
+void
+live_clear(LiveSet *set){
+	memset(set, 0, sizeof(LiveSet));
 }
 
 void
-print_used_helper_function_by_program(void){
-        int i = 0;
-        while(used_helper_functions[i] != NULL){
-                (*used_helper_functions[i])();
-                fprintf(stdout, "\n\n");
-                i++;
-        }
+live_fill(LiveSet *set){
+	set->flags = ALL_FLAGS;
+	set->registers = ALL_REGISTERS;
+	memset(set->zero_page, 0xff, ZERO_PAGE_BYTES);
 }
 
 void
-set_needed_flags(uint8_t index){
-	//get defs and uses of next instructions
-	uint8_t defsNextInstructions = 0;
-	uint8_t usesNextInstructions = 0;
-	toSet = BYTES;
-	
-	uint16_t start = 0;
-	uint16_t i = codeblocks[index].start;
+live_add_zero_page(LiveSet *set, uint16_t address){
+	set->zero_page[address >> 3] |= (1 << (address & 7));
+}
 
-	while((i <= codeblocks[index].end) && (pc != i)){
-		call_corresponding_addressingMode(m[i]);
-		i += bytes;
-		start++;
+void
+live_union(LiveSet *set, LiveSet *other){
+	set->flags |= other->flags;
+	set->registers |= other->registers;
+	for(int i = 0; i < ZERO_PAGE_BYTES; i++){
+		set->zero_page[i] |= other->zero_page[i];
 	}
+}
 
-	for(int i = start+1; i < codeblocks[index].instructions; i++){
-		defsNextInstructions |= codeblocks[index].defs[i];
-		usesNextInstructions |= codeblocks[index].uses[i];
-
+/* live before instruction or block: uses u (live - defs) */
+void
+live_transfer(LiveSet *live, LiveSet *uses, LiveSet *defs){
+	live->flags = uses->flags | (live->flags & ~(defs->flags));
+	live->registers = uses->registers | (live->registers & ~(defs->registers));
+	for(int i = 0; i < ZERO_PAGE_BYTES; i++){
+		live->zero_page[i] = uses->zero_page[i] | (live->zero_page[i] & ~(defs->zero_page[i]));
 	}
-	//get uses by next code block
-	call_corresponding_addressingMode(m[codeblocks[index].end]);
-	uint16_t addressNextBlock = codeblocks[index].end + bytes;
-	uint8_t nextBlock = resolve_address_to_index_in_codeblocks(addressNextBlock);
-	//calculate flags killed by current intruction UNION (flags used by next code block UNION next instructions - flags killed by next instructions)
-	defs = codeblocks[index].defs[start] & ((usesNextInstructions | codeblocks[nextBlock].gen) & ~(defsNextInstructions));
-		
-	//set for AVR Optimization also used flags by next instructions and block in usese Variable for elimitating set_missing_flags optimization
-	uses = ((usesNextInstructions | codeblocks[nextBlock].gen) & ~(defsNextInstructions));
-
-	toSet = IR;
 }
 
-#if AVR
-//in AVR representation jsr contains addresses of targets, in C it contains address of Jumps
 uint8_t
-is_jsr_target(void){
-	for(int i = 0; i < jsr_counter; i++){
-		if(jsr[i] == pc){
+live_intersects(LiveSet *set, LiveSet *other){
+	if((set->flags & other->flags) || (set->registers & other->registers)){
+		return 1;
+	}
+	for(int i = 0; i < ZERO_PAGE_BYTES; i++){
+		if(set->zero_page[i] & other->zero_page[i]){
 			return 1;
 		}
 	}
 	return 0;
 }
-#endif
 
+/* flags (set by representation, see prepare_backend), registers and zero page bytes used and defined by instruction.
+ * Zero page bytes are defined only by exact addresses, indexed and indirect accesses may use every zero page byte */
 void
-print_code_representation(void){
-	toSet = IR;
-	pc = m[0xfffc] | ((uint16_t) m[0xfffd] << 8);
-	uint16_t index = 0;
-
-        while(pc < MEMORY){
-                if(pc == END_PROGRAM){
-                        //0xfffa, 0xfffb, 0xfffc, 0xfffd, 0xfffe, 0xffff are vectors
-                        pc = IO_START;
-                }else if(pc == START_TABLE){
-                        return;
-                }
+get_uses_and_defs(BinaryInstruction *instruction, LiveSet *uses, LiveSet *defs){
+	uint8_t mnemonic = code[instruction->opcode].mnemonic;
+	uint8_t mode = code[instruction->opcode].addressingMode;
+	uint8_t memory = effects[mnemonic].memory;
+	uint16_t address = instruction->operand;
+
+	live_clear(uses);
+	live_clear(defs);
+	uses->flags = instruction->uses;
+	defs->flags = instruction->defs;
+	uses->registers = effects[mnemonic].uses;
+	defs->registers = effects[mnemonic].defs;
+
+	if((mode == 0x1) || (mode == 0x15) || (mode == 0x1d)){
+		uses->registers |= REG_X;
+	}else if((mode == 0x6) || (mode == 0x11) || (mode == 0x19)){
+		uses->registers |= REG_Y;
+	}
 
-                if(is_leader(pc) != -1){
-                        fprintf(stdout, "L%x:\n", pc);
-                        index = resolve_address_to_index_in_codeblocks(pc);
-#if AVR
-			if(jsr_counter > 0){
-				if(is_jsr_target()){
-					printf("\t __asm__ volatile(\"L%x:\");\n", pc);
-				}
+	switch(mode){
+		case 0xa:
+			//accumulator
+			uses->registers |= REG_A;
+			defs->registers |= REG_A;
+			break;
+		case 0x5:
+		case 0xd:
+			//zero page and absolute
+			if((memory == MEM_NONE) || (address > 0xff)){
+				break;
+			}
+			if(memory != MEM_WRITE){
+				live_add_zero_page(uses, address);
+			}
+			if(memory != MEM_READ){
+				live_add_zero_page(defs, address);
+			}
+			break;
+		case 0x1d:
+		case 0x19:
+			//absolute indexed, effective address may wrap around to zero page
+			if((memory != MEM_NONE) && ((address <= 0xff) || (address > 0xff00))){
+				memset(uses->zero_page, 0xff, ZERO_PAGE_BYTES);
+			}
+			break;
+		case 0x1:
+		case 0x6:
+		case 0x11:
+		case 0x15:
+			//zero page indexed and indirect
+			if(memory != MEM_NONE){
+				memset(uses->zero_page, 0xff, ZERO_PAGE_BYTES);
+			}
+			break;
+		case 0x2d:
+			//JMP indirect reads target from vector
+			if(address <= 0xff){
+				live_add_zero_page(uses, address);
+				live_add_zero_page(uses, (address + 1) & 0xff);
+			}
+			break;
+	}
+}
+
+/* instruction has no effect besides defining flags, registers and zero page bytes (see get_uses_and_defs) */
+uint8_t
+is_removable(BinaryInstruction *instruction){
+	uint8_t mnemonic = code[instruction->opcode].mnemonic;
+	uint8_t mode = code[instruction->opcode].addressingMode;
+	uint16_t address = instruction->operand;
+
+	switch(mnemonic){
+		case OP_ADC: case OP_AND: case OP_ASL: case OP_BIT: case OP_CLC: case OP_CLV: case OP_CMP: case OP_CPX:
+		case OP_CPY: case OP_DEC: case OP_DEX: case OP_DEY: case OP_EOR: case OP_INC: case OP_INX: case OP_INY:
+		case OP_LDA: case OP_LDX: case OP_LDY: case OP_LSR: case OP_ORA: case OP_ROL: case OP_ROR: case OP_SBC:
+		case OP_SEC: case OP_STA: case OP_STX: case OP_STY: case OP_TAX: case OP_TAY: case OP_TSX: case OP_TXA:
+		case OP_TYA:
+			break;
+		default:
+			//stack, interrupts, decimal mode, control flow and "illegal" opcodes
+			return 0;
+	}
+	if(is_in_io_operations(instruction->address)){
+		return 0;
+	}
+	switch(mode){
+		case 0x5:
+		case 0xd:
+			if(effects[mnemonic].memory == MEM_READ){
+				return region_kind[address] != REGION_IO;
+			}
+			//only writes to zero page are tracked
+			return (address <= 0xff) && (region_kind[address] == REGION_RAM);
+		case 0x6:
+		case 0x15:
+		case 0x19:
+		case 0x1d:
+			return (effects[mnemonic].memory == MEM_READ) && !check_if_IO_reachable(address);
+		case 0x1:
+		case 0x11:
+			//effective address is not known
+			return 0;
+	}
+	return 1;
+}
+
+/* live before instruction from live after it. Returns 1 and leaves live unchanged if the instruction is removable
+ * and defines nothing live: uses of removed instructions are not live (strong liveness), so whole chains of
+ * unused definitions are removed, e.g. a load only read by a removed compare */
+uint8_t
+live_instruction(BinaryInstruction *instruction, LiveSet *live){
+	LiveSet uses;
+	LiveSet defs;
+
+	get_uses_and_defs(instruction, &uses, &defs);
+	if(is_removable(instruction) && !live_intersects(&defs, live)){
+		return 1;
+	}
+	live_transfer(live, &uses, &defs);
+	return 0;
+}
+
+/* Liveness of flags, registers and zero page: iterative worklist solver
+ * LV_out(u) = U_{s elem succ(u)} LV_in(s), LV_in(u) = gen(u) u (LV_out(u) - kill(u)) (Formula wcre_02, S. 5).
+ * gen and kill depend on LV_out because removed instructions use nothing (see live_instruction),
+ * so LV_in is computed by walking the block and the solution grows from empty sets */
+
+//blocks in reverse postorder of the control flow graph
+uint16_t rpo[MEMORY];
+int number_of_rpo_blocks;
+uint8_t visited[MEMORY];
+
+//statistics of last liveness computation
+int lv_evaluations;
+int lv_passes;
+
+void
+visit_block(uint16_t index, uint16_t postorder[], int *count){
+	//iterative depth first search, deep loop nests must not overflow the C stack
+	static uint16_t stack[MEMORY];
+	static int next_successor[MEMORY];
+	int top = 0;
+
+	visited[index] = 1;
+	stack[top] = index;
+	next_successor[top] = successor_start[index];
+	top++;
+	while(top > 0){
+		uint16_t current = stack[top - 1];
+		if(next_successor[top - 1] < successor_start[current + 1]){
+			uint16_t successor = successors[next_successor[top - 1]++];
+			if(!visited[successor]){
+				visited[successor] = 1;
+				stack[top] = successor;
+				next_successor[top] = successor_start[successor];
+				top++;
+			}
+		}else{
+			postorder[(*count)++] = current;
+			top--;
+		}
+	}
+}
+
+void
+compute_reverse_postorder(void){
+	static uint16_t postorder[MEMORY];
+	int count = 0;
+	memset(visited, 0, sizeof(visited));
+
+	uint16_t entry = m[0xfffc] | ((uint16_t) m[0xfffd] << 8);
+	visit_block(resolve_address_to_index_in_codeblocks(entry), postorder, &count);
+	//blocks not reachable from reset vector are analysed too
+	for(int i = 0; i < number_of_basicblocks; i++){
+		uint16_t index = resolve_address_to_index_in_codeblocks(basicblock_startaddresses[i]);
+		if(!visited[index]){
+			visit_block(index, postorder, &count);
+		}
+	}
+
+	number_of_rpo_blocks = count;
+	for(int i = 0; i < count; i++){
+		rpo[i] = postorder[count - 1 - i];
+	}
+}
+
+void
+live_at_exit(uint16_t index, LiveSet *live){
+	//block without successor: program ends with BRK, everything else (RTS, RTI, dynamic jump) continues unknown
+	if(m[codeblocks[index].end] == 0x00){
+		live_clear(live);
+		return;
+	}
+	live_fill(live);
+}
+
+void
+compute_LV(void){
+	//position of block in reverse postorder and worklist membership
+	static uint16_t position[MEMORY];
+	static uint8_t pending[MEMORY];
+	int remaining = number_of_rpo_blocks;
+
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		position[rpo[i]] = i;
+		pending[i] = 1;
+		live_clear(&codeblocks[rpo[i]].live_in);
+		live_clear(&codeblocks[rpo[i]].live_out);
+	}
+
+	lv_evaluations = 0;
+	lv_passes = 0;
+	while(remaining > 0){
+		//backward problem: sweep reverse postorder from the end, so successors are mostly evaluated first
+		lv_passes++;
+		for(int i = number_of_rpo_blocks - 1; i >= 0; i--){
+			if(!pending[i]){
+				continue;
+			}
+			pending[i] = 0;
+			remaining--;
+			lv_evaluations++;
+
+			uint16_t index = rpo[i];
+			LiveSet lv;
+			live_clear(&lv);
+			if(successor_start[index] == successor_start[index + 1]){
+				live_at_exit(index, &lv);
+			}
+			for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+				//U_{s elem succ(u)} LV(s)
+				live_union(&lv, &codeblocks[successors[j]].live_in);
+			}
+			codeblocks[index].live_out = lv;
+
+			//(LV_out - kill(u)) u gen(u)
+			LiveSet live_in = lv;
+			BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+			//block would start in tables or vectors: nothing is used or defined
+			for(int j = codeblocks[index].instructions - 1; (j >= 0) && (region_kind[index] != REGION_DATA); j--){
+				live_instruction(&block[j], &live_in);
+			}
+			if(memcmp(&live_in, &codeblocks[index].live_in, sizeof(LiveSet)) == 0){
+				continue;
+			}
+			codeblocks[index].live_in = live_in;
+			//result not stable: predecessors have to be evaluated again
+			for(int j = predecessor_start[index]; j < predecessor_start[index + 1]; j++){
+				uint16_t p = position[predecessors[j]];
+				if(!pending[p]){
+					pending[p] = 1;
+					remaining++;
+				}
+			}
+		}
+	}
+}
+
+/* Conditional constant propagation of registers, flags and zero page (Wegman, Zadeck).
+ * The code is not in SSA form, so the value of every cell is kept at the begin of every block.
+ * Edges are only followed if they can be taken with the known flags. Branches with known condition
+ * are printed as jump or not at all, edges which are never taken are removed from the control flow graph */
+#define UNDEFINED -1
+#define VARYING -2
+
+/* registers, flags (0 or 1) and zero page bytes with known value */
+enum{
+	CELL_A = 0,
+	CELL_X,
+	CELL_Y,
+	CELL_N,
+	CELL_Z,
+	CELL_C,
+	CELL_V,
+	CELL_ZERO_PAGE,
+	NUMBER_OF_CELLS = CELL_ZERO_PAGE + 256
+};
+
+typedef struct{
+	//constant value, UNDEFINED if no path reaches cell yet or VARYING
+	int16_t cells[NUMBER_OF_CELLS];
+} ConstantState;
+
+int16_t
+meet(int16_t a, int16_t b){
+	if(a == UNDEFINED){
+		return b;
+	}
+	if((b == UNDEFINED) || (a == b)){
+		return a;
+	}
+	return VARYING;
+}
+
+/* address accessed by instruction, -1 if it depends on a varying register or pointer */
+int
+effective_address(BinaryInstruction *instruction, int16_t cells[]){
+	uint16_t address = instruction->operand;
+	int16_t x = cells[CELL_X];
+	int16_t y = cells[CELL_Y];
+
+	switch(code[instruction->opcode].addressingMode){
+		case 0x5:
+		case 0xd:
+			return address;
+		case 0x15:
+			return (x < 0) ? -1 : ((address + x) & 0xff);
+		case 0x6:
+			return (y < 0) ? -1 : ((address + y) & 0xff);
+		case 0x1d:
+			return (x < 0) ? -1 : (uint16_t) (address + x);
+		case 0x19:
+			return (y < 0) ? -1 : (uint16_t) (address + y);
+		case 0x1:
+			if(x < 0){
+				return -1;
+			}else{
+				int16_t low = cells[CELL_ZERO_PAGE + ((address + x) & 0xff)];
+				int16_t high = cells[CELL_ZERO_PAGE + ((address + x + 1) & 0xff)];
+				return ((low < 0) || (high < 0)) ? -1 : (low | (high << 8));
+			}
+		case 0x11:
+			if(y < 0){
+				return -1;
+			}else{
+				int16_t low = cells[CELL_ZERO_PAGE + address];
+				int16_t high = cells[CELL_ZERO_PAGE + ((address + 1) & 0xff)];
+				return ((low < 0) || (high < 0)) ? -1 : (uint16_t) ((low | (high << 8)) + y);
+			}
+	}
+	return -1;
+}
+
+int16_t
+read_memory(int address, int16_t cells[]){
+	if(address < 0){
+		return VARYING;
+	}
+	if(address <= 0xff){
+		return cells[CELL_ZERO_PAGE + address];
+	}
+	//ROM cannot be modified by the program
+	uint8_t kind = region_kind[address];
+	if((kind == REGION_ROM) || (kind == REGION_DATA) || (kind == REGION_RRIOT_ROM)){
+		return m[address];
+	}
+	return VARYING;
+}
+
+void
+write_memory(BinaryInstruction *instruction, int16_t cells[], int16_t value){
+	int address = effective_address(instruction, cells);
+	if(address >= 0){
+		if(address <= 0xff){
+			cells[CELL_ZERO_PAGE + address] = value;
+		}
+		return;
+	}
+	//unknown address: every zero page byte may be written (see get_uses_and_defs)
+	uint8_t mode = code[instruction->opcode].addressingMode;
+	uint16_t operand = instruction->operand;
+	if((mode == 0x1) || (mode == 0x6) || (mode == 0x11) || (mode == 0x15)
+		|| (((mode == 0x19) || (mode == 0x1d)) && ((operand <= 0xff) || (operand > 0xff00)))){
+		for(int i = 0; i < 256; i++){
+			cells[CELL_ZERO_PAGE + i] = VARYING;
+		}
+	}
+}
+
+void
+set_nz(int16_t cells[], int16_t value){
+	if(value < 0){
+		cells[CELL_N] = VARYING;
+		cells[CELL_Z] = VARYING;
+		return;
+	}
+	cells[CELL_N] = value >> 7;
+	cells[CELL_Z] = (value == 0);
+}
+
+void
+set_result(int16_t cells[], int cell, int16_t value){
+	cells[cell] = value;
+	set_nz(cells, value);
+}
+
+int16_t
+step(int16_t value, int difference){
+	return (value < 0) ? VARYING : ((value + difference) & 0xff);
+}
+
+void
+add_with_carry(int16_t cells[], int16_t value){
+	int16_t a = cells[CELL_A];
+	int16_t carry = cells[CELL_C];
+	if(bcd || (a < 0) || (value < 0) || (carry < 0)){
+		//decimal mode is not folded
+		set_result(cells, CELL_A, VARYING);
+		cells[CELL_C] = VARYING;
+		cells[CELL_V] = VARYING;
+		return;
+	}
+	int sum = a + value + carry;
+	cells[CELL_V] = ((~(a ^ value) & (a ^ sum) & 0x80) != 0);
+	cells[CELL_C] = (sum > 0xff);
+	set_result(cells, CELL_A, sum & 0xff);
+}
+
+void
+compare(int16_t cells[], int16_t reg, int16_t value){
+	if((reg < 0) || (value < 0)){
+		set_nz(cells, VARYING);
+		cells[CELL_C] = VARYING;
+		return;
+	}
+	cells[CELL_C] = (reg >= value);
+	set_nz(cells, (reg - value) & 0xff);
+}
+
+void
+shift(BinaryInstruction *instruction, int16_t cells[], uint8_t mnemonic, int16_t value){
+	int16_t carry = cells[CELL_C];
+	int16_t result = VARYING;
+	int16_t carry_out = VARYING;
+
+	if(value >= 0){
+		if((mnemonic == OP_ASL) || (mnemonic == OP_ROL)){
+			carry_out = value >> 7;
+			result = (value << 1) & 0xff;
+		}else{
+			carry_out = value & 0x1;
+			result = value >> 1;
+		}
+		if((mnemonic == OP_ROL) || (mnemonic == OP_ROR)){
+			if(carry < 0){
+				result = VARYING;
+			}else{
+				result |= (mnemonic == OP_ROL) ? carry : (carry << 7);
+			}
+		}
+	}
+	if(code[instruction->opcode].addressingMode == 0xa){
+		cells[CELL_A] = result;
+	}else{
+		write_memory(instruction, cells, result);
+	}
+	set_nz(cells, result);
+	cells[CELL_C] = carry_out;
+}
+
+/* cells after instruction, 6502 semantic of the binary representation */
+void
+propagate_instruction(BinaryInstruction *instruction, int16_t cells[]){
+	uint8_t mnemonic = code[instruction->opcode].mnemonic;
+	uint8_t mode = code[instruction->opcode].addressingMode;
+	uint8_t memory = effects[mnemonic].memory;
+	int16_t value = VARYING;
+
+	if(mode == 0x9){
+		//immediate
+		value = instruction->operand & 0xff;
+	}else if(mode == 0xa){
+		value = cells[CELL_A];
+	}else if((memory == MEM_READ) || (memory == MEM_MODIFY)){
+		value = read_memory(effective_address(instruction, cells), cells);
+	}
+
+	switch(mnemonic){
+		case OP_LDA:
+			set_result(cells, CELL_A, value);
+			break;
+		case OP_LDX:
+			set_result(cells, CELL_X, value);
+			break;
+		case OP_LDY:
+			set_result(cells, CELL_Y, value);
+			break;
+		case OP_LAX:
+			cells[CELL_X] = value;
+			set_result(cells, CELL_A, value);
+			break;
+		case OP_STA:
+			write_memory(instruction, cells, cells[CELL_A]);
+			break;
+		case OP_STX:
+			write_memory(instruction, cells, cells[CELL_X]);
+			break;
+		case OP_STY:
+			write_memory(instruction, cells, cells[CELL_Y]);
+			break;
+		case OP_TAX:
+			set_result(cells, CELL_X, cells[CELL_A]);
+			break;
+		case OP_TAY:
+			set_result(cells, CELL_Y, cells[CELL_A]);
+			break;
+		case OP_TXA:
+			set_result(cells, CELL_A, cells[CELL_X]);
+			break;
+		case OP_TYA:
+			set_result(cells, CELL_A, cells[CELL_Y]);
+			break;
+		case OP_TSX:
+			//stack pointer is not tracked
+			set_result(cells, CELL_X, VARYING);
+			break;
+		case OP_INX:
+			set_result(cells, CELL_X, step(cells[CELL_X], 1));
+			break;
+		case OP_DEX:
+			set_result(cells, CELL_X, step(cells[CELL_X], -1));
+			break;
+		case OP_INY:
+			set_result(cells, CELL_Y, step(cells[CELL_Y], 1));
+			break;
+		case OP_DEY:
+			set_result(cells, CELL_Y, step(cells[CELL_Y], -1));
+			break;
+		case OP_INC:
+		case OP_DEC:
+			value = step(value, (mnemonic == OP_INC) ? 1 : -1);
+			write_memory(instruction, cells, value);
+			set_nz(cells, value);
+			break;
+		case OP_AND:
+		case OP_ORA:
+		case OP_EOR:
+			if((cells[CELL_A] < 0) || (value < 0)){
+				set_result(cells, CELL_A, VARYING);
+			}else if(mnemonic == OP_AND){
+				set_result(cells, CELL_A, cells[CELL_A] & value);
+			}else if(mnemonic == OP_ORA){
+				set_result(cells, CELL_A, cells[CELL_A] | value);
+			}else{
+				set_result(cells, CELL_A, cells[CELL_A] ^ value);
+			}
+			break;
+		case OP_SBC:
+			//A - M - borrow = A + (M ^ 0xff) + C
+			if(value >= 0){
+				value ^= 0xff;
+			}
+			add_with_carry(cells, value);
+			break;
+		case OP_ADC:
+			add_with_carry(cells, value);
+			break;
+		case OP_CMP:
+			compare(cells, cells[CELL_A], value);
+			break;
+		case OP_CPX:
+			compare(cells, cells[CELL_X], value);
+			break;
+		case OP_CPY:
+			compare(cells, cells[CELL_Y], value);
+			break;
+		case OP_BIT:
+			cells[CELL_N] = (value < 0) ? VARYING : (value >> 7);
+			cells[CELL_V] = (value < 0) ? VARYING : ((value >> 6) & 0x1);
+			cells[CELL_Z] = ((value < 0) || (cells[CELL_A] < 0)) ? VARYING : ((cells[CELL_A] & value) == 0);
+			break;
+		case OP_ASL:
+		case OP_LSR:
+		case OP_ROL:
+		case OP_ROR:
+			shift(instruction, cells, mnemonic, value);
+			break;
+		case OP_CLC:
+			cells[CELL_C] = 0;
+			break;
+		case OP_SEC:
+			cells[CELL_C] = 1;
+			break;
+		case OP_CLV:
+			cells[CELL_V] = 0;
+			break;
+		case OP_PLA:
+			set_result(cells, CELL_A, VARYING);
+			break;
+		case OP_PLP:
+		case OP_RTI:
+			set_nz(cells, VARYING);
+			cells[CELL_C] = VARYING;
+			cells[CELL_V] = VARYING;
+			break;
+		case OP_PHA: case OP_PHP: case OP_CLD: case OP_SED: case OP_CLI: case OP_SEI: case OP_NOP:
+		case OP_JMP: case OP_JSR: case OP_RTS: case OP_BRK: case OP_TXS:
+		case OP_BCC: case OP_BCS: case OP_BEQ: case OP_BMI: case OP_BNE: case OP_BPL: case OP_BVC: case OP_BVS:
+			break;
+		default:
+			//"illegal" opcodes are not folded
+			if(effects[mnemonic].defs & REG_A){
+				cells[CELL_A] = VARYING;
+			}
+			if(effects[mnemonic].defs & REG_X){
+				cells[CELL_X] = VARYING;
+			}
+			set_nz(cells, VARYING);
+			cells[CELL_C] = VARYING;
+			cells[CELL_V] = VARYING;
+			if((memory == MEM_WRITE) || (memory == MEM_MODIFY)){
+				write_memory(instruction, cells, VARYING);
+			}
+			break;
+	}
+}
+
+/* 1 if branch is taken, 0 if not, UNDEFINED or VARYING if flag is not known */
+int16_t
+branch_condition(uint8_t mnemonic, int16_t cells[]){
+	int flag = CELL_C;
+	int16_t taken_if = 1;
+
+	switch(mnemonic){
+		case OP_BCC: flag = CELL_C; taken_if = 0; break;
+		case OP_BCS: flag = CELL_C; taken_if = 1; break;
+		case OP_BNE: flag = CELL_Z; taken_if = 0; break;
+		case OP_BEQ: flag = CELL_Z; taken_if = 1; break;
+		case OP_BPL: flag = CELL_N; taken_if = 0; break;
+		case OP_BMI: flag = CELL_N; taken_if = 1; break;
+		case OP_BVC: flag = CELL_V; taken_if = 0; break;
+		case OP_BVS: flag = CELL_V; taken_if = 1; break;
+	}
+	if(cells[flag] < 0){
+		return cells[flag];
+	}
+	return cells[flag] == taken_if;
+}
+
+void
+propagate_constants(void){
+	static int slot[MEMORY];
+	static uint8_t reached[MEMORY];
+	static uint8_t queued[MEMORY];
+	static uint16_t worklist[MEMORY];
+	static uint8_t feasible[MAX_EDGES];
+	int top = 0;
+
+	ConstantState *states = calloc(number_of_basicblocks, sizeof(ConstantState));
+	if(states == NULL){
+		perror("calloc");
+		exit(1);
+	}
+	memset(reached, 0, sizeof(reached));
+	memset(queued, 0, sizeof(queued));
+	memset(feasible, 0, sizeof(feasible));
+	memset(branch_outcome, 0, sizeof(branch_outcome));
+	for(int i = 0; i < number_of_basicblocks; i++){
+		uint16_t index = resolve_address_to_index_in_codeblocks(basicblock_startaddresses[i]);
+		slot[index] = i;
+		for(int c = 0; c < NUMBER_OF_CELLS; c++){
+			//nothing is known at the entries of the program
+			states[i].cells[c] = is_program_entry(index) ? VARYING : UNDEFINED;
+		}
+		if(is_program_entry(index) && (region_kind[index] != REGION_DATA)){
+			reached[index] = 1;
+			queued[index] = 1;
+			worklist[top++] = index;
+		}
+	}
+
+	while(top > 0){
+		uint16_t index = worklist[--top];
+		queued[index] = 0;
+
+		ConstantState state = states[slot[index]];
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			propagate_instruction(&block[j], state.cells);
+		}
+
+		BinaryInstruction *last = &block[codeblocks[index].instructions - 1];
+		uint8_t opcode = last->opcode;
+		int16_t taken = VARYING;
+		if(is_branch_instruction(opcode)){
+			//last evaluation of block uses the final state
+			taken = branch_condition(code[opcode].mnemonic, state.cells);
+			branch_outcome[last->address] = (taken < 0) ? BRANCH_UNKNOWN : (taken ? BRANCH_ALWAYS_TAKEN : BRANCH_NEVER_TAKEN);
+		}
+		for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+			uint8_t kind = successor_kinds[j];
+			if(is_branch_instruction(opcode)){
+				uint8_t taken_edge = (kind == EDGE_TAKEN) || (kind == EDGE_TAKEN_PAGE);
+				if((taken == UNDEFINED) || ((taken >= 0) && (taken != taken_edge))){
+					continue;
+				}
+			}
+			feasible[j] = 1;
+
+			uint16_t successor = successors[j];
+			int16_t *cells = states[slot[successor]].cells;
+			uint8_t changed = !reached[successor];
+			reached[successor] = 1;
+			for(int c = 0; c < NUMBER_OF_CELLS; c++){
+				//subroutine may change everything before it returns
+				int16_t value = meet(cells[c], (kind == EDGE_RETURN) ? VARYING : state.cells[c]);
+				if(value != cells[c]){
+					cells[c] = value;
+					changed = 1;
+				}
+			}
+			if(changed && !queued[successor]){
+				queued[successor] = 1;
+				worklist[top++] = successor;
+			}
+		}
+	}
+	free(states);
+
+	int branches = 0;
+	int resolved = 0;
+	for(int i = 0; i < number_of_basicblocks; i++){
+		uint16_t index = resolve_address_to_index_in_codeblocks(basicblock_startaddresses[i]);
+		BinaryInstruction *last = &instructions[codeblocks[index].first_instruction + codeblocks[index].instructions - 1];
+		if(!reached[index] || !is_branch_instruction(last->opcode)){
+			continue;
+		}
+		branches++;
+		if(branch_outcome[last->address] != BRANCH_UNKNOWN){
+			resolved++;
+			//flags are not tested by the printed code
+			last->uses = 0;
+		}
+	}
+
+	//edges of a block are consecutive in edge list and successor array (build_cfg)
+	static int next_successor[MEMORY];
+	int kept = 0;
+	memcpy(next_successor, successor_start, sizeof(next_successor));
+	for(int i = 0; i < number_of_edges; i++){
+		if(feasible[next_successor[edges[i].from]++]){
+			edges[kept++] = edges[i];
+		}
+	}
+	fprintf(stderr, "constant propagation: %d of %d branches resolved, %d edges removed\n", resolved, branches, number_of_edges - kept);
+	number_of_edges = kept;
+	build_cfg();
+}
+
+void
+compute_optimization(void){
+	compute_reverse_postorder();
+	compute_LV();
+	fprintf(stderr, "liveness: %d blocks, %d evaluations, %d passes\n", number_of_rpo_blocks, lv_evaluations, lv_passes);
+
+	//instructions not printed by -O 1, their cycles stay in the cycles of their block
+	int removed = 0;
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		LiveSet live = codeblocks[index].live_out;
+		for(int j = codeblocks[index].instructions - 1; (j >= 0) && (region_kind[index] != REGION_DATA); j--){
+			removed += live_instruction(&block[j], &live);
+		}
+	}
+	fprintf(stderr, "dead code: %d instructions removed\n", removed);
+}
+
+/* Promotion of zero page bytes: the most frequently accessed zero page bytes that are only accessed by
+ * their exact address are kept in AVR registers by the representations (see get_promoted_zero_page).
+ * Accesses are weighted by the loop depth of their block, loops are approximated by back edges in reverse postorder */
+#define LOOP_WEIGHT_SHIFT 3
+#define MAX_LOOP_WEIGHT 4
+
+uint8_t promoted_zero_page[MAX_PROMOTED_ZERO_PAGE];
+int number_of_promoted;
+
+void
+promote_zero_page(void){
+	static int position[MEMORY];
+	static int depth[MEMORY];
+	uint32_t weight[RAM_SIZE];
+	//byte is pointer or base of indexed access, its value may be read or written by other addresses
+	uint8_t excluded[RAM_SIZE];
+
+	memset(weight, 0, sizeof(weight));
+	memset(excluded, 0, sizeof(excluded));
+	memset(depth, 0, sizeof(depth));
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		position[rpo[i]] = i;
+	}
+	//blocks between target and source of a back edge in reverse postorder
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		for(int j = successor_start[rpo[i]]; j < successor_start[rpo[i] + 1]; j++){
+			if(visited[successors[j]] && (position[successors[j]] <= i)){
+				for(int k = position[successors[j]]; k <= i; k++){
+					depth[k]++;
+				}
+			}
+		}
+	}
+
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		int loops = (depth[i] < MAX_LOOP_WEIGHT) ? depth[i] : MAX_LOOP_WEIGHT;
+
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			uint8_t mnemonic = code[block[j].opcode].mnemonic;
+			uint8_t mode = code[block[j].opcode].addressingMode;
+			uint16_t address = block[j].operand;
+
+			if((effects[mnemonic].memory == MEM_NONE) && (mode != 0x2d)){
+				continue;
+			}
+			switch(mode){
+				case 0x5:
+				case 0xd:
+					if(address <= 0xff){
+						weight[address] += 1 << (LOOP_WEIGHT_SHIFT * loops);
+					}
+					break;
+				case 0x1:
+				case 0x11:
+				case 0x2d:
+					//pointer
+					if(address <= 0xff){
+						excluded[address] = 1;
+						excluded[(address + 1) & 0xff] = 1;
+					}
+					break;
+				case 0x6:
+				case 0x15:
+				case 0x19:
+				case 0x1d:
+					//base of table
+					if(address <= 0xff){
+						excluded[address] = 1;
+					}
+					break;
+			}
+		}
+	}
+
+	number_of_promoted = 0;
+	while(number_of_promoted < MAX_PROMOTED_ZERO_PAGE){
+		int best = -1;
+		for(int address = 0; address < RAM_SIZE; address++){
+			if(!excluded[address] && (weight[address] > 0) && (region_kind[address] == REGION_RAM)
+					&& ((best < 0) || (weight[address] > weight[best]))){
+				best = address;
+			}
+		}
+		if(best < 0){
+			break;
+		}
+		promoted_zero_page[number_of_promoted++] = best;
+		excluded[best] = 1;
+	}
+	if(number_of_promoted > 0){
+		fprintf(stderr, "zero page promotion: %d bytes promoted to registers\n", number_of_promoted);
+	}
+}
+
+int
+get_promoted_zero_page(uint8_t promoted[]){
+	memcpy(promoted, promoted_zero_page, number_of_promoted);
+	return number_of_promoted;
+}
+
+/* Timing analysis: BCET and WCET in 6502 cycles between I/O instructions.
+ * Natural loops are found with dominators, counted loops (counter loaded by LDX/LDY #imm, decremented or
+ * incremented and tested by BNE) are collapsed to one node. Cycles from the start of an I/O instruction to
+ * the start of the next I/O instruction are then computed for every pair of I/O instructions */
+#define UNBOUNDED_CYCLES (INT64_MAX / 4)
+#define MAX_CALL_DEPTH 16
+
+typedef struct{
+	//best case (BCET)
+	int64_t min;
+	//worst case (WCET), UNBOUNDED_CYCLES if a loop without bound can be repeated
+	int64_t max;
+} Interval;
+
+typedef struct{
+	//header of loop
+	uint16_t header;
+	//source of back edge, -1 if loop has several back edges
+	int latch;
+	//blocks in loop
+	int blocks;
+	//iterations of counted loop, 0 if loop is not bounded
+	int iterations;
+	//cycles of all iterations
+	Interval cycles;
+} Loop;
+
+Loop loops[MEMORY];
+int number_of_loops;
+
+//position of block in reverse postorder, immediate dominator as position (-1 for entries of program)
+int rpo_position[MEMORY];
+int idom[MEMORY];
+//loop collapsed into its header, blocks inside are only reachable by the header
+int collapsed_loop[MEMORY];
+uint8_t absorbed[MEMORY];
+//block can be repeated without I/O instruction
+uint8_t on_cycle[MEMORY];
+//RTS can be reached from block without I/O instruction
+uint8_t returns[MEMORY];
+
+//cycles from start of block to start of I/O instruction (target of current pass) and to the end of the subroutine
+Interval to_io[MEMORY];
+Interval to_rts[MEMORY];
+
+//blocks marked by current walk
+int walk_mark[MEMORY];
+int walk;
+
+Interval
+no_path(void){
+	Interval result = {UNBOUNDED_CYCLES, -1};
+	return result;
+}
+
+uint8_t
+is_no_path(Interval a){
+	return a.max < 0;
+}
+
+Interval
+interval_add(Interval a, Interval b){
+	if(is_no_path(a) || is_no_path(b)){
+		return no_path();
+	}
+	Interval result = {a.min + b.min, a.max + b.max};
+	if(result.min > UNBOUNDED_CYCLES){
+		result.min = UNBOUNDED_CYCLES;
+	}
+	if(result.max > UNBOUNDED_CYCLES){
+		result.max = UNBOUNDED_CYCLES;
+	}
+	return result;
+}
+
+Interval
+interval_union(Interval a, Interval b){
+	if(is_no_path(a)){
+		return b;
+	}
+	if(is_no_path(b)){
+		return a;
+	}
+	Interval result = {a.min < b.min ? a.min : b.min, a.max > b.max ? a.max : b.max};
+	return result;
+}
+
+Interval
+interval_of(int64_t min, int64_t max){
+	Interval result = {min, max};
+	return result;
+}
+
+/* cycles of one execution of a block or of a collapsed loop */
+Interval
+node_cycles(uint16_t index){
+	if(collapsed_loop[index] >= 0){
+		return loops[collapsed_loop[index]].cycles;
+	}
+	return interval_of(codeblocks[index].cycles, codeblocks[index].cycles + codeblocks[index].penalty);
+}
+
+BinaryInstruction *
+last_instruction(uint16_t index){
+	return &instructions[codeblocks[index].first_instruction + codeblocks[index].instructions - 1];
+}
+
+uint8_t
+ends_with_io(uint16_t index){
+	return is_in_io_operations(codeblocks[index].end);
+}
+
+/* cycles of I/O instruction at end of block */
+Interval
+io_cycles(uint16_t index){
+	BinaryInstruction *instruction = last_instruction(index);
+	return interval_of(instruction->cycles, instruction->cycles + has_page_cross_penalty(instruction));
+}
+
+/* successors of a block for the timing analysis: a collapsed loop continues at its exit,
+ * a subroutine called by JSR is accounted by the JSR block itself (see compute_to_io) */
+int
+timing_successors(uint16_t index, uint16_t next[], uint8_t cycles[]){
+	int count = 0;
+	if(collapsed_loop[index] >= 0){
+		Loop *loop = &loops[collapsed_loop[index]];
+		for(int j = successor_start[loop->latch]; j < successor_start[loop->latch + 1]; j++){
+			if(successor_kinds[j] == EDGE_FALLTHROUGH){
+				next[count] = successors[j];
+				cycles[count++] = successor_cycles[j];
+			}
+		}
+		return count;
+	}
+	if(last_instruction(index)->opcode == 0x20){
+		return 0;
+	}
+	for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+		if(successor_kinds[j] != EDGE_RETURN){
+			next[count] = successors[j];
+			cycles[count++] = successor_cycles[j];
+		}
+	}
+	return count;
+}
+
+/* target and return block of a JSR block, return is -1 if no code follows JSR */
+void
+jsr_blocks(uint16_t index, uint16_t *target, int *back){
+	*back = -1;
+	for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+		if(successor_kinds[j] == EDGE_RETURN){
+			*back = successors[j];
+		}else{
+			*target = successors[j];
+		}
+	}
+}
+
+/* dominators over positions in reverse postorder (Cooper, Harvey, Kennedy: A Simple, Fast Dominance Algorithm) */
+int
+intersect(int a, int b){
+	while(a != b){
+		while(a > b){
+			a = idom[a];
+		}
+		while(b > a){
+			b = idom[b];
+		}
+	}
+	return a;
+}
+
+void
+compute_dominators(void){
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		rpo_position[rpo[i]] = i;
+	}
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		//block without predecessor before it in reverse postorder is an entry of the program
+		idom[i] = -1;
+		for(int j = predecessor_start[rpo[i]]; j < predecessor_start[rpo[i] + 1]; j++){
+			if(rpo_position[predecessors[j]] < i){
+				idom[i] = -2;
+			}
+		}
+	}
+	uint8_t changed = 1;
+	while(changed){
+		changed = 0;
+		for(int i = 0; i < number_of_rpo_blocks; i++){
+			if(idom[i] == -1){
+				continue;
+			}
+			int new_idom = -2;
+			for(int j = predecessor_start[rpo[i]]; j < predecessor_start[rpo[i] + 1]; j++){
+				int p = rpo_position[predecessors[j]];
+				if(idom[p] == -2){
+					//predecessor not processed yet
+					continue;
+				}
+				new_idom = (new_idom == -2) ? p : intersect(p, new_idom);
+			}
+			if(idom[i] != new_idom){
+				idom[i] = new_idom;
+				changed = 1;
+			}
+		}
+	}
+}
+
+uint8_t
+dominates(uint16_t a, uint16_t b){
+	int position = rpo_position[b];
+	while(position > rpo_position[a]){
+		position = idom[position];
+	}
+	return position == rpo_position[a];
+}
+
+/* marks blocks of natural loop with new walk, returns number of blocks */
+int
+walk_loop(Loop *loop){
+	static uint16_t stack[MEMORY];
+	int top = 0;
+	int blocks = 1;
+	walk++;
+	walk_mark[loop->header] = walk;
+	for(int j = predecessor_start[loop->header]; j < predecessor_start[loop->header + 1]; j++){
+		uint16_t p = predecessors[j];
+		if(dominates(loop->header, p) && (walk_mark[p] != walk)){
+			walk_mark[p] = walk;
+			stack[top++] = p;
+			blocks++;
+		}
+	}
+	while(top > 0){
+		uint16_t current = stack[--top];
+		for(int j = predecessor_start[current]; j < predecessor_start[current + 1]; j++){
+			uint16_t p = predecessors[j];
+			if(walk_mark[p] != walk){
+				walk_mark[p] = walk;
+				stack[top++] = p;
+				blocks++;
+			}
+		}
+	}
+	return blocks;
+}
+
+void
+find_loops(void){
+	static int loop_of_header[MEMORY];
+	number_of_loops = 0;
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		loop_of_header[rpo[i]] = -1;
+	}
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+			uint16_t header = successors[j];
+			if(!dominates(header, index)){
+				continue;
+			}
+			//back edge
+			if(loop_of_header[header] == -1){
+				loop_of_header[header] = number_of_loops;
+				loops[number_of_loops].header = header;
+				loops[number_of_loops].latch = index;
+				loops[number_of_loops].iterations = 0;
+				number_of_loops++;
+			}else if(loops[loop_of_header[header]].latch != index){
+				loops[loop_of_header[header]].latch = -1;
+			}
+		}
+	}
+	for(int i = 0; i < number_of_loops; i++){
+		loops[i].blocks = walk_loop(&loops[i]);
+	}
+}
+
+uint8_t
+writes_register(uint8_t mnemonic, uint8_t counter){
+	if(counter == OP_LDX){
+		return (mnemonic == OP_LDX) || (mnemonic == OP_TAX) || (mnemonic == OP_TSX) || (mnemonic == OP_INX)
+			|| (mnemonic == OP_DEX) || (mnemonic == OP_LAX) || (mnemonic == OP_SBX) || (mnemonic == OP_LAS);
+	}
+	return (mnemonic == OP_LDY) || (mnemonic == OP_TAY) || (mnemonic == OP_INY) || (mnemonic == OP_DEY);
+}
+
+/* only predecessor of header outside of loop (marked by last walk), -1 if loop has several entries */
+int
+loop_entry(Loop *loop){
+	int entry = -1;
+	for(int j = predecessor_start[loop->header]; j < predecessor_start[loop->header + 1]; j++){
+		if(walk_mark[predecessors[j]] == walk){
+			continue;
+		}
+		if(entry != -1){
+			return -1;
+		}
+		entry = predecessors[j];
+	}
+	return entry;
+}
+
+/* value of X (counter == OP_LDX) or Y (OP_LDY) at end of block if last written by LDX or LDY immediate, -1 otherwise */
+int
+loaded_value(uint16_t index, uint8_t counter){
+	BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+	for(int j = codeblocks[index].instructions - 1; j >= 0; j--){
+		if(!writes_register(code[block[j].opcode].mnemonic, counter)){
+			continue;
+		}
+		if((code[block[j].opcode].mnemonic != counter) || (code[block[j].opcode].addressingMode != 0x9)){
+			return -1;
+		}
+		return block[j].operand & 0xff;
+	}
+	return -1;
+}
+
+/* iterations of a counted loop: latch ends with DEX, DEY, INX or INY followed by BNE to the header, the counter
+ * is not written elsewhere in the loop and loaded by LDX or LDY immediate before the only entry. 0 if not counted */
+int
+count_iterations(Loop *loop){
+	uint16_t latch = loop->latch;
+	BinaryInstruction *branch = last_instruction(latch);
+	if((branch->opcode != 0xd0) || (branch->parameter != loop->header) || (codeblocks[latch].instructions < 2)){
+		return 0;
+	}
+	uint8_t step = code[(branch - 1)->opcode].mnemonic;
+	uint8_t counter = ((step == OP_DEX) || (step == OP_INX)) ? OP_LDX : OP_LDY;
+	if((step != OP_DEX) && (step != OP_DEY) && (step != OP_INX) && (step != OP_INY)){
+		return 0;
+	}
+
+	//blocks of loop (marked by last walk) must not write counter
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		if(walk_mark[index] != walk){
+			continue;
+		}
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			if((&block[j] != branch - 1) && writes_register(code[block[j].opcode].mnemonic, counter)){
+				return 0;
+			}
+		}
+	}
+	int entry = loop_entry(loop);
+	if(entry == -1){
+		return 0;
+	}
+
+	//last write of counter before loop
+	int start = loaded_value(entry, counter);
+	if(start == -1){
+		return 0;
+	}
+	if(start == 0){
+		return 256;
+	}
+	return ((step == OP_DEX) || (step == OP_DEY)) ? start : 256 - start;
+}
+
+/* cycles of one iteration of a counted loop from start of header to end of latch (forward in reverse postorder) */
+uint8_t
+compute_iteration(Loop *loop, Interval *iteration){
+	static Interval distance[MEMORY];
+	uint16_t next[4];
+	uint8_t cycles[4];
+
+	for(int i = rpo_position[loop->header]; i < number_of_rpo_blocks; i++){
+		distance[rpo[i]] = no_path();
+	}
+	distance[loop->header] = interval_of(0, 0);
+	for(int i = rpo_position[loop->header]; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		if((walk_mark[index] != walk) || absorbed[index]){
+			continue;
+		}
+		if((collapsed_loop[index] == -2) && (index != loop->header)){
+			//inner loop without bound
+			return 0;
+		}
+		if((collapsed_loop[index] < 0) && (ends_with_io(index) || ends_control_flow(last_instruction(index)->opcode)
+			|| (last_instruction(index)->opcode == 0x20))){
+			//I/O, subroutine or end of program inside loop
+			return 0;
+		}
+		Interval end = interval_add(distance[index], node_cycles(index));
+		int count = timing_successors(index, next, cycles);
+		for(int j = 0; j < count; j++){
+			if(next[j] == loop->header){
+				continue;
+			}
+			if(walk_mark[next[j]] != walk){
+				//only exit of loop is branch of latch not taken
+				if((index != loop->latch) || (collapsed_loop[index] >= 0)){
+					return 0;
+				}
+				continue;
+			}
+			distance[next[j]] = interval_union(distance[next[j]], interval_add(end, interval_of(cycles[j], cycles[j])));
+		}
+	}
+	*iteration = interval_add(distance[loop->latch], node_cycles(loop->latch));
+	return 1;
+}
+
+int
+compare_loops(const void *a, const void *b){
+	return ((Loop *) a)->blocks - ((Loop *) b)->blocks;
+}
+
+/* collapses counted loops, inner loops (less blocks) first */
+void
+bound_loops(void){
+	qsort(loops, number_of_loops, sizeof(Loop), compare_loops);
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		collapsed_loop[rpo[i]] = -1;
+		absorbed[rpo[i]] = 0;
+	}
+	for(int i = 0; i < number_of_loops; i++){
+		//loop header not collapsed: loop without bound
+		collapsed_loop[loops[i].header] = -2;
+	}
+	for(int i = 0; i < number_of_loops; i++){
+		Loop *loop = &loops[i];
+		Interval iteration;
+		walk_loop(loop);
+		if((loop->latch == -1) || ((loop->iterations = count_iterations(loop)) == 0) || !compute_iteration(loop, &iteration)){
+			loop->iterations = 0;
+			continue;
+		}
+		int64_t back_edge = 0;
+		for(int j = successor_start[loop->latch]; j < successor_start[loop->latch + 1]; j++){
+			if(successors[j] == loop->header){
+				back_edge = successor_cycles[j];
+			}
+		}
+		//every iteration but the last takes the back edge
+		loop->cycles.min = loop->iterations * iteration.min + (loop->iterations - 1) * back_edge;
+		loop->cycles.max = loop->iterations * iteration.max + (loop->iterations - 1) * back_edge;
+		for(int j = 0; j < number_of_rpo_blocks; j++){
+			if(walk_mark[rpo[j]] == walk){
+				absorbed[rpo[j]] = 1;
+			}
+		}
+		absorbed[loop->header] = 0;
+		collapsed_loop[loop->header] = i;
+	}
+}
+
+/* blocks reaching themselves without passing an I/O instruction (loops without bound or recursion) */
+int
+timing_dependencies(uint16_t index, uint16_t next[]){
+	uint8_t cycles[4];
+	if(ends_with_io(index) && (collapsed_loop[index] < 0)){
+		return 0;
+	}
+	if((collapsed_loop[index] < 0) && (last_instruction(index)->opcode == 0x20)){
+		uint16_t target = 0;
+		int back;
+		jsr_blocks(index, &target, &back);
+		next[0] = target;
+		if((back == -1) || !returns[target]){
+			//code after JSR is only reached by the subroutine after an I/O instruction
+			return 1;
+		}
+		next[1] = back;
+		return 2;
+	}
+	return timing_successors(index, next, cycles);
+}
+
+void
+find_returning_blocks(void){
+	uint16_t next[4];
+	uint8_t cycles[4];
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		returns[rpo[i]] = 0;
+	}
+	uint8_t changed = 1;
+	while(changed){
+		changed = 0;
+		for(int i = number_of_rpo_blocks - 1; i >= 0; i--){
+			uint16_t index = rpo[i];
+			if(absorbed[index] || returns[index] || (ends_with_io(index) && (collapsed_loop[index] < 0))){
+				continue;
+			}
+			uint8_t result = 0;
+			if((collapsed_loop[index] < 0) && (last_instruction(index)->opcode == 0x60)){
+				result = 1;
+			}else if((collapsed_loop[index] < 0) && (last_instruction(index)->opcode == 0x20)){
+				uint16_t target = 0;
+				int back;
+				jsr_blocks(index, &target, &back);
+				result = (back != -1) && returns[target] && returns[back];
+			}else{
+				int count = timing_successors(index, next, cycles);
+				for(int j = 0; j < count; j++){
+					result |= returns[next[j]];
+				}
+			}
+			if(result){
+				returns[index] = 1;
+				changed = 1;
+			}
+		}
+	}
+}
+
+void
+find_cycles(void){
+	static uint16_t stack[MEMORY];
+	uint16_t next[4];
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t start = rpo[i];
+		on_cycle[start] = 0;
+		if(absorbed[start]){
+			continue;
+		}
+		int top = 0;
+		walk++;
+		stack[top++] = start;
+		while((top > 0) && !on_cycle[start]){
+			uint16_t current = stack[--top];
+			int count = timing_dependencies(current, next);
+			for(int j = 0; j < count; j++){
+				if(next[j] == start){
+					on_cycle[start] = 1;
+				}else if(walk_mark[next[j]] != walk){
+					walk_mark[next[j]] = walk;
+					stack[top++] = next[j];
+				}
+			}
+		}
+	}
+}
+
+/* cycles from start of every block to start of I/O instruction at end of block target (target < 0: to end of
+ * subroutine only). Iterated until stable, blocks on a cycle have no upper bound */
+void
+compute_to_io(int target){
+	uint16_t next[4];
+	uint8_t cycles[4];
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		to_io[rpo[i]] = no_path();
+		if(target < 0){
+			to_rts[rpo[i]] = no_path();
+		}
+	}
+	uint8_t changed = 1;
+	while(changed){
+		changed = 0;
+		for(int i = number_of_rpo_blocks - 1; i >= 0; i--){
+			uint16_t index = rpo[i];
+			if(absorbed[index]){
+				continue;
+			}
+			Interval io = no_path();
+			Interval rts = no_path();
+			Interval own = node_cycles(index);
+			if((collapsed_loop[index] < 0) && ends_with_io(index)){
+				if(index == target){
+					Interval io_instruction = io_cycles(index);
+					io = interval_of(own.min - io_instruction.min, own.max - io_instruction.max);
+				}
+			}else if((collapsed_loop[index] < 0) && (last_instruction(index)->opcode == 0x60)){
+				rts = own;
+			}else if((collapsed_loop[index] < 0) && (last_instruction(index)->opcode == 0x20)){
+				//subroutine ends with I/O or returns and continues to I/O
+				uint16_t called = 0;
+				int back;
+				jsr_blocks(index, &called, &back);
+				io = to_io[called];
+				if(back != -1){
+					io = interval_union(io, interval_add(to_rts[called], to_io[back]));
+					rts = interval_add(own, interval_add(to_rts[called], to_rts[back]));
+				}
+				io = interval_add(own, io);
+			}else{
+				int count = timing_successors(index, next, cycles);
+				for(int j = 0; j < count; j++){
+					Interval edge = interval_add(own, interval_of(cycles[j], cycles[j]));
+					io = interval_union(io, interval_add(edge, to_io[next[j]]));
+					rts = interval_union(rts, interval_add(edge, to_rts[next[j]]));
+				}
+			}
+			if(on_cycle[index]){
+				if(!is_no_path(io)){
+					io.max = UNBOUNDED_CYCLES;
+				}
+				if(!is_no_path(rts)){
+					rts.max = UNBOUNDED_CYCLES;
+				}
+			}
+			io = interval_union(io, to_io[index]);
+			if((io.min != to_io[index].min) || (io.max != to_io[index].max)){
+				to_io[index] = io;
+				changed = 1;
+			}
+			if(target < 0){
+				rts = interval_union(rts, to_rts[index]);
+				if((rts.min != to_rts[index].min) || (rts.max != to_rts[index].max)){
+					to_rts[index] = rts;
+					changed = 1;
+				}
+			}
+		}
+	}
+}
+
+/* block is reached from entry of subroutine before RTS */
+uint8_t
+in_subroutine(uint16_t entry, uint16_t index){
+	static uint16_t stack[MEMORY];
+	uint16_t next[4];
+	uint8_t cycles[4];
+	int top = 0;
+	walk++;
+	walk_mark[entry] = walk;
+	stack[top++] = entry;
+	while(top > 0){
+		uint16_t current = stack[--top];
+		if(current == index){
+			return 1;
+		}
+		int count;
+		if((collapsed_loop[current] < 0) && (last_instruction(current)->opcode == 0x20)){
+			int back;
+			jsr_blocks(current, &next[0], &back);
+			count = (back != -1);
+			next[0] = back;
+		}else{
+			count = timing_successors(current, next, cycles);
+		}
+		for(int j = 0; j < count; j++){
+			if(walk_mark[next[j]] != walk){
+				walk_mark[next[j]] = walk;
+				stack[top++] = next[j];
+			}
+		}
+	}
+	return 0;
+}
+
+/* I/O instruction is followed by RTS: continue after every JSR calling the subroutine */
+Interval
+after_return(uint16_t index, Interval rts, int depth){
+	Interval result = no_path();
+	if(depth == MAX_CALL_DEPTH){
+		return result;
+	}
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t call = rpo[i];
+		if(absorbed[call] || (collapsed_loop[call] >= 0) || (last_instruction(call)->opcode != 0x20)){
+			continue;
+		}
+		uint16_t called = 0;
+		int back;
+		jsr_blocks(call, &called, &back);
+		if((back == -1) || !in_subroutine(called, index)){
+			continue;
+		}
+		result = interval_union(result, interval_add(rts, to_io[back]));
+		if(!is_no_path(to_rts[back])){
+			result = interval_union(result, after_return(call, interval_add(rts, to_rts[back]), depth + 1));
+		}
+	}
+	return result;
+}
+
+/* cycles from start of I/O instruction at end of block source to start of I/O instruction of current pass */
+Interval
+io_to_io(uint16_t source){
+	uint16_t next[4];
+	uint8_t cycles[4];
+	Interval io = no_path();
+	Interval rts = no_path();
+	Interval own = io_cycles(source);
+	int count = timing_successors(source, next, cycles);
+	for(int j = 0; j < count; j++){
+		Interval edge = interval_add(own, interval_of(cycles[j], cycles[j]));
+		io = interval_union(io, interval_add(edge, to_io[next[j]]));
+		rts = interval_union(rts, interval_add(edge, to_rts[next[j]]));
+	}
+	if(!is_no_path(rts)){
+		io = interval_union(io, after_return(source, rts, 0));
+	}
+	return io;
+}
+
+void
+print_cycles(FILE *report, int64_t cycles){
+	if(cycles >= UNBOUNDED_CYCLES){
+		fprintf(report, "unbounded");
+	}else{
+		fprintf(report, "%lld", (long long) cycles);
+	}
+}
+
+void
+print_interval(FILE *report, const char *kind, uint16_t from, uint16_t to, Interval interval){
+	fprintf(report, "%s %x -> I/O %x: bcet %lld wcet ", kind, from, to, (long long) interval.min);
+	print_cycles(report, interval.max);
+	fprintf(report, " jitter ");
+	print_cycles(report, (interval.max >= UNBOUNDED_CYCLES) ? interval.max : interval.max - interval.min);
+	fprintf(report, "\n");
+}
+
+void
+print_timing_report(char *filename){
+	FILE *report = fopen(filename, "w");
+	if(report == NULL){
+		perror("fopen");
+		exit(1);
+	}
+	compute_dominators();
+	find_loops();
+	bound_loops();
+	find_returning_blocks();
+	find_cycles();
+
+	fprintf(report, "timing report: 6502 cycles from start of I/O instruction to start of next I/O instruction\n");
+	for(int i = 0; i < number_of_loops; i++){
+		fprintf(report, "loop %x: %d blocks, ", loops[i].header, loops[i].blocks);
+		if(loops[i].iterations == 0){
+			fprintf(report, "not bounded\n");
+			continue;
+		}
+		fprintf(report, "%d iterations, bcet %lld wcet %lld\n", loops[i].iterations, (long long) loops[i].cycles.min, (long long) loops[i].cycles.max);
+	}
+
+	//subroutines are summarised once, then every I/O instruction is target of one pass
+	compute_to_io(-1);
+	uint16_t vectors[3] = {RESET_VECTOR, NMI_VECTOR, IRQ_VECTOR};
+	const char *entries[3] = {"reset", "nmi", "irq"};
+	for(int t = 0; t < number_of_rpo_blocks; t++){
+		uint16_t target = rpo[t];
+		if(absorbed[target] || !ends_with_io(target)){
+			continue;
+		}
+		compute_to_io(target);
+		for(int v = 0; v < 3; v++){
+			if((v > 0) && ((image_start > vectors[v]) || (image_end < vectors[v] + 1))){
+				continue;
+			}
+			uint16_t entry = m[vectors[v]] | ((uint16_t) m[vectors[v] + 1] << 8);
+			if(!is_no_path(to_io[entry])){
+				print_interval(report, entries[v], entry, codeblocks[target].end, to_io[entry]);
+			}
+		}
+		for(int s = 0; s < number_of_rpo_blocks; s++){
+			uint16_t source = rpo[s];
+			if(absorbed[source] || !ends_with_io(source)){
+				continue;
+			}
+			Interval interval = io_to_io(source);
+			if(!is_no_path(interval)){
+				print_interval(report, "I/O", codeblocks[source].end, codeblocks[target].end, interval);
+			}
+		}
+	}
+	fclose(report);
+}
+
+/* Delay loops (-O 1): a bounded loop (see bound_loops) containing only DEX, DEY, INX, INY, LDX and LDY immediate,
+ * NOP and branches on N or Z is executed at translation time. It is printed as one addition of its cycles
+ * followed by the live registers and flags it leaves, the wait itself happens at the next synchronisation */
+#define MAX_DELAY_LOOP_BLOCKS (1L << 24)
+
+typedef struct{
+	//first and last address of loop, loop is left by the instruction following last
+	uint16_t start;
+	uint16_t end;
+	//cycles of all iterations
+	uint32_t cycles;
+	//X and Y after loop, -1 if not written by loop or not live
+	int x;
+	int y;
+	//result N and Z are set from after loop, -1 if flags are not live
+	int result;
+} DelayLoop;
+
+DelayLoop delay_loops[MEMORY];
+int number_of_delay_loops;
+//index of collapsed delay loop with header at block, -1 for other blocks
+int delay_loop_of[MEMORY];
+//block is part of a collapsed delay loop
+uint8_t in_delay_loop[MEMORY];
+
+uint8_t
+is_delay_instruction(BinaryInstruction *instruction){
+	switch(code[instruction->opcode].mnemonic){
+		case OP_DEX: case OP_DEY: case OP_INX: case OP_INY: case OP_NOP:
+		case OP_BNE: case OP_BEQ: case OP_BPL: case OP_BMI:
+			return !is_in_io_operations(instruction->address);
+		case OP_LDX: case OP_LDY:
+			return code[instruction->opcode].addressingMode == 0x9;
+	}
+	return 0;
+}
+
+/* blocks of loop (marked by last walk) cover the instructions from start of header to end of latch,
+ * contain only delay instructions and are not entered by JSR */
+uint8_t
+is_delay_loop(Loop *loop){
+	if(loop->latch == -1){
+		return 0;
+	}
+	uint16_t start = codeblocks[loop->header].start;
+	uint16_t end = codeblocks[loop->latch].end;
+	long bytes = 0;
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		if(walk_mark[index] != walk){
+			continue;
+		}
+		if((codeblocks[index].start < start) || (codeblocks[index].end > end) || in_delay_loop[index]
+				|| codeblocks[index].penalty){
+			return 0;
+		}
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			if(!is_delay_instruction(&block[j]) || (address_attributes[block[j].address] & ATTR_JSR_TARGET)){
+				return 0;
+			}
+			bytes += block[j].bytes;
+		}
+	}
+	//blocks do not overlap, so they leave no gap if their sizes add up to the range
+	return bytes == (end + last_instruction(loop->latch)->bytes - start);
+}
+
+/* executes delay loop (marked by last walk) from its header with X and Y (-1 if not known),
+ * returns block control continues with after loop, -1 if a value is not known or loop does not end */
+int
+run_delay_loop(uint16_t header, int *x, int *y, int *result, int64_t *cycles){
+	uint16_t index = header;
+	*result = -1;
+	*cycles = 0;
+	for(long blocks = 0; blocks < MAX_DELAY_LOOP_BLOCKS; blocks++){
+		if(walk_mark[index] != walk){
+			return index;
+		}
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		uint8_t taken = 0;
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			uint8_t mnemonic = code[block[j].opcode].mnemonic;
+			int *reg = ((mnemonic == OP_LDX) || (mnemonic == OP_DEX) || (mnemonic == OP_INX)) ? x : y;
+			switch(mnemonic){
+				case OP_LDX:
+				case OP_LDY:
+					*reg = block[j].operand & 0xff;
+					*result = *reg;
+					break;
+				case OP_DEX:
+				case OP_DEY:
+				case OP_INX:
+				case OP_INY:
+					if(*reg == -1){
+						return -1;
+					}
+					*reg = (*reg + (((mnemonic == OP_INX) || (mnemonic == OP_INY)) ? 1 : -1)) & 0xff;
+					*result = *reg;
+					break;
+				case OP_BNE:
+				case OP_BEQ:
+				case OP_BPL:
+				case OP_BMI:
+					if(*result == -1){
+						return -1;
+					}
+					taken = (mnemonic == OP_BNE) ? (*result != 0) : (mnemonic == OP_BEQ) ? (*result == 0)
+						: (mnemonic == OP_BPL) ? !(*result & 0x80) : ((*result & 0x80) != 0);
+					break;
+			}
+		}
+		*cycles += codeblocks[index].cycles;
+		int next = -1;
+		for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+			uint8_t kind = successor_kinds[j];
+			if(taken ? ((kind == EDGE_TAKEN) || (kind == EDGE_TAKEN_PAGE)) : (kind == EDGE_FALLTHROUGH)){
+				next = successors[j];
+				*cycles += successor_cycles[j];
+			}
+		}
+		if(next == -1){
+			return -1;
+		}
+		index = next;
+	}
+	return -1;
+}
+
+/* outermost delay loops are collapsed (loops are sorted by number of blocks) */
+void
+collapse_delay_loops(void){
+	number_of_delay_loops = 0;
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		delay_loop_of[rpo[i]] = -1;
+		in_delay_loop[rpo[i]] = 0;
+	}
+	compute_dominators();
+	find_loops();
+	bound_loops();
+
+	for(int i = number_of_loops - 1; i >= 0; i--){
+		Loop *loop = &loops[i];
+		walk_loop(loop);
+		int entry = loop_entry(loop);
+		if((loop->iterations == 0) || (loop->cycles.min != loop->cycles.max) || (entry == -1) || !is_delay_loop(loop)){
+			continue;
+		}
+		int x = loaded_value(entry, OP_LDX);
+		int y = loaded_value(entry, OP_LDY);
+		int result;
+		int64_t cycles;
+		uint16_t end = codeblocks[loop->latch].end;
+		uint16_t following = end + last_instruction(loop->latch)->bytes;
+		int exit = run_delay_loop(loop->header, &x, &y, &result, &cycles);
+		//bound of timing analysis is used, execution only gives the state after the loop
+		if((exit == -1) || (cycles != loop->cycles.max) || !is_instruction(following)
+				|| (codeblocks[exit].start != following)){
+			continue;
+		}
+
+		DelayLoop *delay = &delay_loops[number_of_delay_loops];
+		delay->start = codeblocks[loop->header].start;
+		delay->end = end;
+		delay->cycles = loop->cycles.max;
+		LiveSet *live = &codeblocks[exit].live_in;
+		delay->x = (live->registers & REG_X) ? x : -1;
+		delay->y = (live->registers & REG_Y) ? y : -1;
+		delay->result = (live->flags & ((1 << NF) | (1 << ZF))) ? result : -1;
+		for(int j = 0; j < number_of_rpo_blocks; j++){
+			if(walk_mark[rpo[j]] == walk){
+				in_delay_loop[rpo[j]] = 1;
+			}
+		}
+		delay_loop_of[loop->header] = number_of_delay_loops;
+		number_of_delay_loops++;
+	}
+	if(number_of_delay_loops > 0){
+		fprintf(stderr, "delay loops: %d loops collapsed\n", number_of_delay_loops);
+	}
+}
+
+/* Call graph: a subroutine called by JSR is translated to a function of the representation if it is well-formed.
+ * Its code is only entered by JSR at the entry, only left by RTS, PHA/PHP and PLA/PLP are balanced and it calls
+ * only subroutines which are functions themselves. All other code stays in main and returns by dispatch */
+
+//entry of function containing instruction at address, -1 for code in main
+int function_of[MEMORY];
+//functions in address order
+uint16_t function_entries[MEMORY];
+int number_of_functions;
+
+//blocks of subroutine found by last walk_subroutine
+uint16_t subroutine_blocks[MEMORY];
+int number_of_subroutine_blocks;
+
+/* collects blocks reached from entry until RTS (calls are stepped over), returns 0 if subroutine is not well-formed */
+uint8_t
+walk_subroutine(uint16_t entry){
+	static int depth[MEMORY];
+	number_of_subroutine_blocks = 0;
+	walk++;
+	walk_mark[entry] = walk;
+	depth[entry] = 0;
+	subroutine_blocks[number_of_subroutine_blocks++] = entry;
+
+	for(int i = 0; i < number_of_subroutine_blocks; i++){
+		uint16_t index = subroutine_blocks[i];
+		if(is_program_entry(index)){
+			return 0;
+		}
+		//stack depth at end of block, relative to entry of subroutine
+		int stack = depth[index];
+		BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+		for(int j = 0; j < codeblocks[index].instructions; j++){
+			uint8_t mnemonic = code[block[j].opcode].mnemonic;
+			if((mnemonic == OP_PHA) || (mnemonic == OP_PHP)){
+				stack++;
+			}else if((mnemonic == OP_PLA) || (mnemonic == OP_PLP)){
+				stack--;
+			}else if((mnemonic == OP_TSX) || (mnemonic == OP_TXS)){
+				return 0;
+			}
+			if(stack < 0){
+				//return address pulled from stack
+				return 0;
+			}
+		}
+		uint8_t opcode = last_instruction(index)->opcode;
+		if(opcode == 0x60){
+			if(stack != 0){
+				return 0;
+			}
+			continue;
+		}
+		if(ends_control_flow(opcode) || is_dynamic_jump(last_instruction(index))
+			|| jumps_to_stop(last_instruction(index)) || falls_into_stop(last_instruction(index))){
+			//RTI, BRK, JAM, JMP with vector in RAM or target inside an instruction
+			return 0;
+		}
+
+		for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+			if((opcode == 0x20) && (successor_kinds[j] != EDGE_RETURN)){
+				//called subroutine is stepped over
+				continue;
+			}
+			uint16_t next = successors[j];
+			if(walk_mark[next] != walk){
+				walk_mark[next] = walk;
+				depth[next] = stack;
+				subroutine_blocks[number_of_subroutine_blocks++] = next;
+			}else if(depth[next] != stack){
+				return 0;
+			}
+		}
+	}
+
+	//code of subroutine is only entered by JSR at entry
+	for(int i = 0; i < number_of_subroutine_blocks; i++){
+		uint16_t index = subroutine_blocks[i];
+		for(int j = predecessor_start[index]; j < predecessor_start[index + 1]; j++){
+			uint16_t p = predecessors[j];
+			uint8_t call = (last_instruction(p)->opcode == 0x20) && (last_instruction(p)->parameter == index);
+			if(index == entry){
+				if(!call && (walk_mark[p] != walk)){
+					return 0;
+				}
+			}else if(call || (walk_mark[p] != walk)){
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+void
+find_functions(void){
+	static uint8_t is_function[MEMORY];
+	static int owner[MEMORY];
+	int subroutines = 0;
+
+	for(int i = 0; i < number_of_instructions; i++){
+		uint16_t address = instructions[i].address;
+		is_function[address] = 0;
+		if((address_attributes[address] & ATTR_JSR_TARGET) && (is_leader(address) != -1)){
+			subroutines++;
+			is_function[address] = walk_subroutine(address);
+		}
+	}
+
+	//code shared by subroutines or calling code in main stays in main, repeated until stable
+	uint8_t changed = 1;
+	while(changed){
+		changed = 0;
+		for(int i = 0; i < number_of_instructions; i++){
+			owner[instructions[i].address] = -1;
+		}
+		for(int i = 0; i < number_of_instructions; i++){
+			uint16_t entry = instructions[i].address;
+			if(!is_function[entry]){
+				continue;
+			}
+			walk_subroutine(entry);
+			for(int j = 0; j < number_of_subroutine_blocks; j++){
+				uint16_t index = subroutine_blocks[j];
+				BinaryInstruction *instruction = last_instruction(index);
+				if((instruction->opcode == 0x20) && !is_function[instruction->parameter]){
+					is_function[entry] = 0;
+					changed = 1;
+					break;
+				}
+				if((owner[index] != -1) && (owner[index] != entry)){
+					is_function[entry] = 0;
+					is_function[owner[index]] = 0;
+					changed = 1;
+					break;
+				}
+				owner[index] = entry;
+			}
+		}
+	}
+
+	for(int i = 0; i < MEMORY; i++){
+		function_of[i] = -1;
+	}
+	number_of_functions = 0;
+	for(int i = 0; i < number_of_instructions; i++){
+		uint16_t entry = instructions[i].address;
+		if(!is_function[entry]){
+			continue;
+		}
+		function_entries[number_of_functions++] = entry;
+		walk_subroutine(entry);
+		for(int j = 0; j < number_of_subroutine_blocks; j++){
+			uint16_t index = subroutine_blocks[j];
+			for(int k = codeblocks[index].first_instruction; k < codeblocks[index].first_instruction + codeblocks[index].instructions; k++){
+				function_of[instructions[k].address] = entry;
+			}
+		}
+	}
+	fprintf(stderr, "%d of %d subroutines translated to functions\n", number_of_functions, subroutines);
+}
+
+int
+get_function(uint16_t address){
+	return function_of[address];
+}
+
+/* Inlining: a function without branches, jumps and calls of a few instructions (leaf subroutine) is copied
+ * to every JSR. The cycles of JSR and RTS stay in the cycle accounting of the copy */
+#define MAX_INLINED_INSTRUCTIONS 8
+
+uint8_t inlined[MEMORY];
+
+void
+find_inlined_functions(void){
+	int number_of_inlined = 0;
+	for(int i = 0; i < number_of_functions; i++){
+		uint16_t entry = function_entries[i];
+		inlined[entry] = 0;
+		for(int j = instruction_index[entry]; j < instruction_index[entry] + MAX_INLINED_INSTRUCTIONS; j++){
+			uint8_t opcode = instructions[j].opcode;
+			if(opcode == 0x60){
+				inlined[entry] = 1;
+				number_of_inlined++;
+				break;
+			}
+			if(is_branch_instruction(opcode) || is_jump(opcode) || ends_control_flow(opcode) || (j + 1 == number_of_instructions)
+				|| (instructions[j + 1].address != instructions[j].address + instructions[j].bytes)){
+				//no straight-line code
+				break;
+			}
+		}
+	}
+	fprintf(stderr, "%d functions inlined\n", number_of_inlined);
+}
+
+uint8_t
+is_inlined(uint16_t entry){
+	return (get_function(entry) == entry) && inlined[entry];
+}
+
+/* instruction is part of inlined function, it is only printed at the JSR */
+uint8_t
+is_inlined_code(uint16_t address){
+	return (get_function(address) != -1) && inlined[get_function(address)];
+}
+
+/* Code for printing */
+int
+block_cycles(uint16_t index){
+	if(wcet){
+		return codeblocks[index].cycles + codeblocks[index].penalty;
+	}
+	return codeblocks[index].cycles;
+}
+
+/* cycles of block if control leaves it by the taken branch */
+int
+block_cycles_taken(uint16_t index){
+	for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+		if((successor_kinds[j] == EDGE_TAKEN) || (successor_kinds[j] == EDGE_TAKEN_PAGE)){
+			return block_cycles(index) + successor_cycles[j];
+		}
+	}
+	return block_cycles(index);
+}
+
+/* Batched cycle accounting (-O 1): the cycles of a block are not added at its end. They are carried at
+ * translation time into its successors and added where carried cycles of joining paths differ.
+ * A block continues with the smallest cycles carried on its incoming edges, the rest is added on the edges.
+ * Cycles are added completely before I/O instructions, JSR and RTS and at loop headers (back edges)
+ * and entries of the program, subroutines and functions */
+uint16_t carried_cycles[MEMORY];
+
+/* cycles not yet added when control leaves block by an edge with edge_cycles additional cycles */
+int
+outgoing_cycles(uint16_t index, int edge_cycles){
+	if(ends_with_io(index)){
+		//cycles before I/O instruction are added before synchronisation
+		return last_instruction(index)->cycles;
+	}
+	return carried_cycles[index] + block_cycles(index) + edge_cycles;
+}
+
+/* all edges into block are forward edges in reverse postorder from blocks of same function,
+ * which add the cycles of the edge before the branch, jump or fall through to the block */
+uint8_t
+can_carry_cycles(uint16_t index, int position[]){
+	uint16_t address = codeblocks[index].start;
+	if(is_program_entry(address) || (address_attributes[address] & ATTR_JSR_TARGET) || is_inlined_code(address)
+			|| (get_function(address) == address) || (predecessor_start[index] == predecessor_start[index + 1])){
+		return 0;
+	}
+	for(int k = predecessor_start[index]; k < predecessor_start[index + 1]; k++){
+		uint16_t predecessor = predecessors[k];
+		uint8_t opcode = last_instruction(predecessor)->opcode;
+		if((position[predecessor] >= position[index]) || is_inlined_code(codeblocks[predecessor].start) || in_delay_loop[predecessor]
+				|| (get_function(codeblocks[predecessor].start) != get_function(address))
+				|| (opcode == 0x20) || (opcode == 0x6c)){
+			//back edge, call, return, dynamic jump or exit of collapsed delay loop
+			return 0;
+		}
+	}
+	return 1;
+}
+
+void
+batch_cycles(void){
+	static int position[MEMORY];
+	int batched = 0;
+
+	memset(carried_cycles, 0, sizeof(carried_cycles));
+	if(!optimization){
+		return;
+	}
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		position[rpo[i]] = i;
+	}
+	//predecessors are handled before their successors (forward edges only)
+	for(int i = 0; i < number_of_rpo_blocks; i++){
+		uint16_t index = rpo[i];
+		if(!can_carry_cycles(index, position)){
+			continue;
+		}
+		int carried = -1;
+		for(int k = predecessor_start[index]; k < predecessor_start[index + 1]; k++){
+			uint16_t predecessor = predecessors[k];
+			for(int j = successor_start[predecessor]; j < successor_start[predecessor + 1]; j++){
+				int cycles = outgoing_cycles(predecessor, successor_cycles[j]);
+				if((successors[j] == index) && ((carried < 0) || (cycles < carried))){
+					carried = cycles;
+				}
+			}
+		}
+		carried_cycles[index] = carried;
+		if(carried > 0){
+			batched++;
+		}
+	}
+	fprintf(stderr, "cycle batching: %d blocks continue with cycles of their predecessors\n", batched);
+}
+
+/* cycles added when control leaves block by edge of kind (EDGE_TAKEN for both taken edges) */
+int
+edge_cycles(uint16_t index, uint8_t kind){
+	for(int j = successor_start[index]; j < successor_start[index + 1]; j++){
+		uint8_t edge = (successor_kinds[j] == EDGE_TAKEN_PAGE) ? EDGE_TAKEN : successor_kinds[j];
+		if(edge == kind){
+			return outgoing_cycles(index, successor_cycles[j]) - carried_cycles[successors[j]];
+		}
+	}
+	//no successor or edge removed by constant propagation
+	return outgoing_cycles(index, 0);
+}
+
+/* cycles of branch or jump at end of block printed by representation */
+void
+set_branch_cycles(uint16_t index){
+	cycles = edge_cycles(index, EDGE_FALLTHROUGH);
+	cycles_taken = edge_cycles(index, EDGE_TAKEN);
+	if(m[codeblocks[index].end] == 0x4c){
+		cycles = edge_cycles(index, EDGE_JUMP);
+	}
+}
+
+void
+print_added_cycles(int value){
+	(*backend->add_cycles)(value);
+}
+
+uint8_t
+is_branch(uint16_t pc){
+	return is_branch_instruction(m[pc]) || is_jump(m[pc]);
+}
+
+void
+set_needed_flags(uint16_t index){
+	BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+	int start = instruction_index[pc] - codeblocks[index].first_instruction;
+
+	if((start < 0) || (start >= codeblocks[index].instructions)){
+		//instruction is not part of an analysed block: all flags needed
+		defs = instructions[instruction_index[pc]].defs;
+		uses = ALL_FLAGS;
+		toSet = IR;
+		return;
+	}
+
+	//flags live after current instruction: walk backwards from end of block, removed instructions use no flags
+	LiveSet live = codeblocks[index].live_out;
+	for(int j = codeblocks[index].instructions - 1; j > start; j--){
+		live_instruction(&block[j], &live);
+	}
+	//only flags which are defined by current instruction and live afterwards have to be calculated
+	defs = block[start].defs & live.flags;
+		
+	//set for AVR Optimization also used flags by next instructions and block in usese Variable for elimitating set_missing_flags optimization
+	uses = live.flags;
+
+	toSet = IR;
+}
+
+/* nothing defined by instruction at pc is live afterwards: its code is not printed,
+ * its cycles are still counted with the cycles of the block */
+uint8_t
+is_dead_store(uint16_t index){
+	BinaryInstruction *block = &instructions[codeblocks[index].first_instruction];
+	int start = instruction_index[pc] - codeblocks[index].first_instruction;
+
+	if((start < 0) || (start >= codeblocks[index].instructions)){
+		return 0;
+	}
+	LiveSet live = codeblocks[index].live_out;
+	for(int j = codeblocks[index].instructions - 1; j > start; j--){
+		live_instruction(&block[j], &live);
+	}
+	return live_instruction(&block[start], &live);
+}
+
+uint8_t
+is_jsr_target(void){
+	return (address_attributes[pc] & ATTR_JSR_TARGET) != 0;
+}
+
+/* code for target inside an instruction (see stop_target), printed after the instruction falling into it
+ * or at the end of the code of the function jumping to it */
+void
+print_stop(uint16_t address){
+	printf("L%x:\n", address);
+	if((backend == &avr_backend) && (address_attributes[address] & ATTR_JSR_TARGET)){
+		printf("\t __asm__ volatile(\"L%x:\");\n", address);
+	}
+	printf("\t //%x is inside an instruction, not translated\n", address);
+	toSet = IR;
+	(*backend->opcodes[OP_BRK])();
+	stop_printed[address] = 1;
+}
+
+void
+print_stops(int function){
+	for(int i = 0; i < number_of_instructions; i++){
+		if(is_inlined_code(instructions[i].address) || ((backend->function_prolog != NULL) && (get_function(instructions[i].address) != function))){
+			continue;
+		}
+		uint16_t target = instructions[i].parameter;
+		if(jumps_to_stop(&instructions[i]) && !stop_printed[target]){
+			print_stop(target);
+		}
+	}
+	memset(stop_printed, 0, sizeof(stop_printed));
+}
+
+/* branch with condition known by constant propagation: no test of flags is printed */
+void
+print_resolved_branch(BinaryInstruction *instruction){
+	if(branch_outcome[pc] == BRANCH_ALWAYS_TAKEN){
+		printf("\t //%x branch always taken\n", pc);
+		print_added_cycles(cycles_taken);
+		printf("\t goto L%x;\n", instruction->parameter);
+	}else{
+		printf("\t //%x branch never taken\n", pc);
+		print_added_cycles(cycles);
+	}
+}
+
+void
+print_inlined_function(uint16_t call, uint16_t entry){
+	uint16_t jsr = pc;
+	uint16_t index = resolve_address_to_index_in_codeblocks(entry);
+	printf("\t //JSR %x inlined\n", entry);
+	print_added_cycles(carried_cycles[call] + block_cycles(call));
+	for(int i = instruction_index[entry]; i < number_of_instructions; i++){
+		pc = instructions[i].address;
+		if(optimization){
+			set_needed_flags(index);
+		}else{
+			toSet = IR;
+		}
+		if(instructions[i].opcode == 0x60){
+			//RTS
+			print_added_cycles(block_cycles(index));
+			break;
+		}
+		if(is_in_io_operations(pc)){
+			cycles = block_cycles(index) - instructions[i].cycles;
+			print_added_cycles(cycles);
+			(*backend->opcodes[code[m[pc]].mnemonic])();
+			print_added_cycles(instructions[i].cycles);
+			index = resolve_address_to_index_in_codeblocks(pc + instructions[i].bytes);
+			continue;
+		}
+		if(optimization && is_dead_store(index)){
+			printf("\t //%x removed, result not used\n", pc);
+			continue;
+		}
+		(*backend->opcodes[code[m[pc]].mnemonic])();
+	}
+	pc = jsr;
+}
+
+void
+print_code_representation(int function){
+        uint16_t index = 0;
+	int last = -1;
+
+	//walk decoded instructions of main or function in address order
+        for(int i = 0; i < number_of_instructions; i++){
+		if(is_inlined_code(instructions[i].address) || ((backend->function_prolog != NULL) && (get_function(instructions[i].address) != function))){
+			continue;
+		}
+		if((last >= 0) && falls_into_stop(&instructions[last])){
+			print_stop(instructions[last].address + instructions[last].bytes);
+		}
+		last = i;
+		toSet = IR;
+		pc = instructions[i].address;
+		uint16_t next = pc + instructions[i].bytes;
+
+                if(is_leader(pc) != -1){
+                        fprintf(stdout, "L%x:\n", pc);
+                        index = resolve_address_to_index_in_codeblocks(pc);
+			if((backend == &avr_backend) && is_jsr_target()){
+				printf("\t __asm__ volatile(\"L%x:\");\n", pc);
 			}
-#endif
                 }
 		if(is_branch(pc) == 1){
-                        cycles = codeblocks[index].cycles;
-                        (*code[m[pc]].opcode)();
-#if C
-			uint8_t opcode = m[pc];
-#endif
-                        get_next_instruction();
+                        cycles = block_cycles(index);
+                        cycles_taken = block_cycles_taken(index);
+			if((instructions[i].opcode == 0x20) && is_inlined(instructions[i].parameter)){
+				print_inlined_function(index, instructions[i].parameter);
+			}else{
+				(*backend->opcodes[code[m[pc]].mnemonic])();
+			}
+                        pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
-#if C
-			if((opcode == 0x20) && (is_leader(pc) == -1)){
-				//print additional label for return from subroutine
+			if((backend == &c_backend) && (instructions[i].opcode == 0x20) && (is_leader(pc) == -1)
+				&& !stop_target[pc] && (get_function(instructions[i].parameter) != instructions[i].parameter)){
+				//print additional label for return from subroutine by dispatch
 				printf("L%x:\n", pc);
 			}
-#endif
                         continue;
                 }else if(is_in_io_operations(pc)){
-			cycles = codeblocks[index].cycles - code[m[pc]].cycles;
-			if(cycles != 0){
-				printf("\t cycles += %d;\n", cycles);
-			}
-                        (*code[m[pc]].opcode)();
-                        printf("\t cycles += %d;\n", code[m[pc]].cycles);
-			get_next_instruction();
+			cycles = block_cycles(index) - instructions[i].cycles;
+			print_added_cycles(cycles);
+                        (*backend->opcodes[code[m[pc]].mnemonic])();
+                        print_added_cycles(instructions[i].cycles);
+			pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
                         continue;
 		}else if(m[pc] == 0x60){
                         //RTS
-                        printf("\t cycles += %d;\n", codeblocks[index].cycles);
-			(*code[m[pc]].opcode)();
-                        get_next_instruction();
+                        print_added_cycles(block_cycles(index));
+			(*backend->opcodes[code[m[pc]].mnemonic])();
+                        pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
                         continue;
                 } 
 		if((m[pc] == 0x00) && (m[pc+1] == 0)){
-                        printf("\t cycles += %d;\n", codeblocks[index].cycles);
-                        return;
+                        //end of program, code of other entries may follow
+                        print_added_cycles(block_cycles(index));
+                        pc = next;
+                        continue;
                 }
 
-                (*code[m[pc]].opcode)();
+                (*backend->opcodes[code[m[pc]].mnemonic])();
 
                 if(pc == codeblocks[index].end){
-                        printf("\t cycles += %d;\n", codeblocks[index].cycles);
-			get_next_instruction();
+                        print_added_cycles(block_cycles(index));
+			pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
                         continue;
                 }
-                get_next_instruction();
+                pc = next;
         }
+	if((last >= 0) && falls_into_stop(&instructions[last])){
+		print_stop(instructions[last].address + instructions[last].bytes);
+	}
+	print_stops(function);
 }
 
 void
-print_optimized_code_representation(void){
-	toSet = IR;
-        pc = m[0xfffc] | ((uint16_t) m[0xfffd] << 8);
+print_optimized_code_representation(int function){
         uint16_t index = 0;
-        while(pc < MEMORY){
-                if(pc == END_PROGRAM){
-                        //0xfffa, 0xfffb, 0xfffc, 0xfffd, 0xfffe, 0xffff are vectors
-                        pc = IO_START;
-                }else if(pc == START_TABLE){
-                        return;
-                }
+	int last = -1;
+
+	//walk decoded instructions of main or function in address order
+        for(int i = 0; i < number_of_instructions; i++){
+		if(is_inlined_code(instructions[i].address) || ((backend->function_prolog != NULL) && (get_function(instructions[i].address) != function))){
+			continue;
+		}
+		if((last >= 0) && falls_into_stop(&instructions[last])){
+			print_stop(instructions[last].address + instructions[last].bytes);
+		}
+		last = i;
+		toSet = IR;
+		pc = instructions[i].address;
+		uint16_t next = pc + instructions[i].bytes;
 
                 if(is_leader(pc) != -1){
                         fprintf(stdout, "L%x:\n", pc);
                         index = resolve_address_to_index_in_codeblocks(pc);
                         set_needed_flags(index);
-#if AVR
-                        if(jsr_counter > 0){
-                                if(is_jsr_target()){
-                                        printf("\t __asm__ volatile(\"L%x:\");\n", pc);
-                                }
+                        if((backend == &avr_backend) && is_jsr_target()){
+                                printf("\t __asm__ volatile(\"L%x:\");\n", pc);
                         }
-#endif
 
                 }
+		if((delay_loop_of[index] >= 0) && (pc == codeblocks[index].start) && (backend->delay_loop != NULL)){
+			DelayLoop *delay = &delay_loops[delay_loop_of[index]];
+			printf("\t //%x - %x delay loop collapsed\n", delay->start, delay->end);
+			(*backend->delay_loop)(delay->cycles, delay->x, delay->y, delay->result);
+			//instructions of loop are not printed, code continues with instruction following loop
+			while((i + 1 < number_of_instructions) && (instructions[i + 1].address <= delay->end)){
+				i++;
+			}
+			last = i;
+			pc = instructions[i].address + instructions[i].bytes;
+			index = resolve_address_to_index_in_codeblocks(pc);
+			set_needed_flags(index);
+			continue;
+		}
 		if(is_branch(pc) == 1){
-                        cycles = codeblocks[index].cycles;
-                        (*code[m[pc]].opcode)();
-#if C
-                        uint8_t opcode = m[pc];
-#endif
-
-                        get_next_instruction();
+			set_branch_cycles(index);
+			if((instructions[i].opcode == 0x20) && is_inlined(instructions[i].parameter)){
+				print_inlined_function(index, instructions[i].parameter);
+			}else if(branch_outcome[pc] != BRANCH_UNKNOWN){
+				print_resolved_branch(&instructions[i]);
+			}else{
+				(*backend->opcodes[code[m[pc]].mnemonic])();
+			}
+                        pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
-#if C
-                        if((opcode == 0x20) && (is_leader(pc) == -1)){
-                                //print additional label for return from subroutine
+                        if((backend == &c_backend) && (instructions[i].opcode == 0x20) && (is_leader(pc) == -1)
+				&& !stop_target[pc] && (get_function(instructions[i].parameter) != instructions[i].parameter)){
+                                //print additional label for return from subroutine by dispatch
                                 printf("L%x:\n", pc);
                         }
-#endif
 
 			set_needed_flags(index);
                         continue;
                 }else if(is_in_io_operations(pc)){
-			cycles = codeblocks[index].cycles - code[m[pc]].cycles;
-			if(cycles != 0){
-                                printf("\t cycles += %d;\n", cycles);
-                        }
-                        (*code[m[pc]].opcode)();
-                        printf("\t cycles += %d;\n", code[m[pc]].cycles);
-                        get_next_instruction();
+			print_added_cycles(carried_cycles[index] + block_cycles(index) - instructions[i].cycles);
+                        (*backend->opcodes[code[m[pc]].mnemonic])();
+			print_added_cycles(edge_cycles(index, EDGE_FALLTHROUGH));
+                        pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
 			set_needed_flags(index);
                         continue;
                 }else if(m[pc] == 0x60){
 			//RTS
-			printf("\t cycles += %d;\n", codeblocks[index].cycles);
-			(*code[m[pc]].opcode)();
-			get_next_instruction();
+			print_added_cycles(carried_cycles[index] + block_cycles(index));
+			(*backend->opcodes[code[m[pc]].mnemonic])();
+			pc = next;
                         index = resolve_address_to_index_in_codeblocks(pc);
 			continue;
 		}
 		if((m[pc] == 0x00) && (m[pc+1] == 0x00)){
-                        printf("\t cycles += %d;\n", codeblocks[index].cycles);
-                        return;
+                        //end of program, code of other entries may follow
+			print_added_cycles(carried_cycles[index] + block_cycles(index));
+                        pc = next;
+                        continue;
                 }
 
-		(*code[m[pc]].opcode)();
+		if(is_dead_store(index)){
+			printf("\t //%x removed, result not used\n", pc);
+		}else{
+			(*backend->opcodes[code[m[pc]].mnemonic])();
+		}
 
                 if(pc == codeblocks[index].end){
-                        printf("\t cycles += %d;\n", codeblocks[index].cycles);
-			get_next_instruction();
+			print_added_cycles(edge_cycles(index, EDGE_FALLTHROUGH));
+			pc = next;
 			index = resolve_address_to_index_in_codeblocks(pc);
 			continue;
                 }
 
-                get_next_instruction();
+                pc = next;
 		set_needed_flags(index);
         }
-
+	if((last >= 0) && falls_into_stop(&instructions[last])){
+		print_stop(instructions[last].address + instructions[last].bytes);
+	}
+	print_stops(function);
 }
 
 
 void
-print_code(uint16_t lastPC){
+print_instructions(int function){
+	if(optimization){
+		print_optimized_code_representation(function);
+	}else{
+		print_code_representation(function);
+	}
+}
+
+void
+print_code(void){
 	toSet = IR;
 	cycles = 0;
-	print_prolog();
-	print_global_vars_and_functions();
-	print_used_helper_function_by_program();
-	print_main();
+	(*backend->prolog)();
+	(*backend->global_vars_and_functions)();
+	(*backend->helper_functions)();
 
-	if(optimization){
-		print_optimized_code_representation();
-	}else{
-		print_code_representation();
+	if(backend->function_prolog != NULL){
+		for(int i = 0; i < number_of_functions; i++){
+			if(inlined[function_entries[i]]){
+				continue;
+			}
+			(*backend->function_prolog)(function_entries[i]);
+			print_instructions(function_entries[i]);
+			(*backend->function_epilog)();
+		}
+	}
+	(*backend->main)();
+
+	//code is printed in address order, execution starts at reset vector
+	uint16_t entry = m[RESET_VECTOR] | ((uint16_t) m[RESET_VECTOR + 1] << 8);
+	for(int i = 0; i < number_of_instructions; i++){
+		if(is_inlined_code(instructions[i].address) || ((backend->function_prolog != NULL) && (get_function(instructions[i].address) != -1))){
+			continue;
+		}
+		if(instructions[i].address != entry){
+			printf("\t goto L%x;\n", entry);
+		}
+		break;
 	}
+	print_instructions(-1);
 
-	print_epilog();
+	(*backend->epilog)();
 }
 
 /* Functions for loading memory m addressable by 6502 */
 
 void
-load_program_from_file(char* filename, int size, int offset){
+load_program_from_file(char* filename, int offset){
         int fd = open(filename, O_RDONLY);
         if (fd < 0) { perror("open"); exit(1); }
-        int n = read(fd, m+offset, 65536);
-	m[0xfffc] = offset & 0xff;
-	m[0xfffd] = offset >> 8;
+        int n = read(fd, m+offset, MEMORY - offset);
+        if (n < 0) { perror("read"); exit(1); }
+        close(fd);
+        map_image(offset, n);
+	if(offset + n <= 0xfffc){
+		//image contains no reset vector: start executing code at begin of image
+		m[0xfffc] = offset & 0xff;
+		m[0xfffd] = offset >> 8;
+	}
         fprintf(stderr,"%d bytes gelesen\n", n);
 }
 
@@ -802,6 +3596,7 @@ load_into_memory(uint8_t program[], int size, int offset){
                 // 0xFFFC - 0x1 = 0xFFFB (CLC can be 1 Bytes before begin of program)
                 m[i + offset] = program[i];
         }
+        map_image(offset, size);
         //set reset vector to start executing code at 0x0100 (LE)
         m[0xFFFC] = (offset & 0xFF);
         m[0xFFFD] = (offset >> 8);
@@ -809,47 +3604,190 @@ load_into_memory(uint8_t program[], int size, int offset){
         return 0;
 }
 
+/* Variants of generated code, several variants are printed from one analysis */
+#define MAX_VARIANTS 16
+
+typedef struct{
+	//output file, NULL == stdout
+	char *filename;
+	//index of representation in backends
+	int backend;
+	//1 == WCET, 0 == BCET
+	uint8_t wcet;
+	//optimization level, 0 == optimization is not applied
+	int optimization;
+	//length of output queue, 0 == no run-ahead
+	uint8_t output_queue;
+}Variant;
+
+Variant variants[MAX_VARIANTS];
+int number_of_variants;
+
+void
+add_variant(char *filename, int backend, uint8_t wcet, int optimization, uint8_t output_queue){
+	if(number_of_variants == MAX_VARIANTS){
+		fprintf(stderr, "too many output files\n");
+		exit(1);
+	}
+	variants[number_of_variants].filename = filename;
+	variants[number_of_variants].backend = backend;
+	variants[number_of_variants].wcet = wcet;
+	variants[number_of_variants].optimization = optimization;
+	variants[number_of_variants].output_queue = output_queue;
+	number_of_variants++;
+}
+
+void
+print_usage(char *name){
+	fprintf(stderr, "usage: %s [-m memory map] [-l load address] [-b c|avr] [-t wcet|bcet] [-O level] [-q length] [-o output] ... [-r report] [image]\n", name);
+	fprintf(stderr, "\t -m file\t memory map of 6502 system (default: system of thesis)\n");
+	fprintf(stderr, "\t -l address\t load address of image (default: 0xf000)\n");
+	fprintf(stderr, "\t -b name\t representation of generated code: c or avr (default: c)\n");
+	fprintf(stderr, "\t -t timing\t wcet or bcet for synchronisation (default: wcet)\n");
+	fprintf(stderr, "\t -O level\t 0 == no optimization, 1 == optimization of flags (default: 1)\n");
+	fprintf(stderr, "\t -q length\t outputs wait in queue of length 2 ... 128 (power of two) while program goes on (default: 0, no queue)\n");
+	fprintf(stderr, "\t -o file\t print variant with options given before to file, can be repeated\n");
+	fprintf(stderr, "\t -r file\t print timing report (cycles between I/O instructions, loop bounds) to file\n");
+	fprintf(stderr, "without image the test program of the thesis is translated\n");
+}
+
 int
-main(void){
+main(int argc, char *argv[]){
 	/* setup of environment */
 	toSet = 0;
-	codeBlockCapacity = ROM_SIZE;
 	//number_of_branches = 0;
         dynamicTargetAmount = 0;
 	IOops = 0;
 	number_of_leaders = 0;
-	jsr_counter = 0;
 
-	rom_addr = 0;
-	rriot_addr = 0;
+	/* options */
+	char *memory_map_file = NULL;
+	char *report_file = NULL;
+	long offset = 0xf000;
+	int backend_option = 0;
+	uint8_t wcet_option = 1;
+	int optimization_option = 1;
+	long queue_option = 0;
+	number_of_variants = 0;
+
+	int option;
+	while((option = getopt(argc, argv, "m:l:b:t:O:q:o:r:h")) != -1){
+		switch(option){
+			case 'm':
+				memory_map_file = optarg;
+				break;
+			case 'l':
+				offset = strtol(optarg, NULL, 0);
+				if((offset < 0) || (offset >= MEMORY)){
+					fprintf(stderr, "invalid load address %s\n", optarg);
+					exit(1);
+				}
+				break;
+			case 'b':
+				for(backend_option = 0; backend_option < NUMBER_OF_BACKENDS; backend_option++){
+					if(strcmp(optarg, backends[backend_option]->name) == 0){
+						break;
+					}
+				}
+				if(backend_option == NUMBER_OF_BACKENDS){
+					fprintf(stderr, "unknown representation %s\n", optarg);
+					exit(1);
+				}
+				break;
+			case 't':
+				if(strcmp(optarg, "wcet") == 0){
+					wcet_option = 1;
+				}else if(strcmp(optarg, "bcet") == 0){
+					wcet_option = 0;
+				}else{
+					print_usage(argv[0]);
+					exit(1);
+				}
+				break;
+			case 'O':
+				optimization_option = atoi(optarg);
+				break;
+			case 'q':
+				queue_option = strtol(optarg, NULL, 0);
+				if((queue_option < 0) || (queue_option > 128) || (queue_option == 1) || (queue_option & (queue_option - 1))){
+					fprintf(stderr, "invalid queue length %s\n", optarg);
+					exit(1);
+				}
+				break;
+			case 'o':
+				add_variant(optarg, backend_option, wcet_option, optimization_option, queue_option);
+				break;
+			case 'r':
+				report_file = optarg;
+				break;
+			default:
+				print_usage(argv[0]);
+				exit(1);
+		}
+	}
+	if(number_of_variants == 0){
+		//no output file: print to stdout
+		add_variant(NULL, backend_option, wcet_option, optimization_option, queue_option);
+	}
+
+	/* memory map of system, default is system of thesis */
+	if(memory_map_file != NULL){
+		load_memory_map(memory_map_file);
+	}
+	apply_memory_map();
 
-	// 1 == Optimization is applied, 0 == optimization is not applied
-#if OPTIMIZATION
-	optimization = 1;
-#else 
-	optimization = 0;
-#endif
-	
-	/* Alphabet Programm with Delay */
-	//load_program_from_file("abc_300.bin", 4096, 0xf000);
-        
-	/* ABC Test */
-	uint8_t test_program[] = {0x18, 0xA9, 0x41, 0x8D, 0x00, 0x8b, 0x69, 0x01, 0xC9, 0x5B, 0x90, 0xF7, 0x00};
-        int size = 13;
-	load_into_memory(test_program, size, 0xf000);
+	if(optind < argc){
+		/* e.g. Alphabet Programm with Delay: abc_300.bin */
+		load_program_from_file(argv[optind], offset);
+	}else{
+		/* ABC Test */
+		uint8_t test_program[] = {0x18, 0xA9, 0x41, 0x8D, 0x00, 0x8b, 0x69, 0x01, 0xC9, 0x5B, 0x90, 0xF7, 0x00};
+		int size = 13;
+		load_into_memory(test_program, size, offset);
+	}
+	//addresses of image not in memory map are ROM now
+	index_memory_regions();
 
 	/* analyse binary */
-	uint16_t lastPC = find_leaders_and_branches();
+	find_leaders_and_branches();
 
 	complete_block();
 
-	analyse_uses_and_defs_code_block();
+	find_functions();
+
+	find_inlined_functions();
+
+	prepare_backend(variants[0].backend);
+
+	propagate_constants();
 
 	compute_optimization();
 
-	//printf("start: %x, end: %x\n", startBlock, endBlock);
+	promote_zero_page();
+
+	collapse_delay_loops();
 
-	print_code(lastPC);
+	if(report_file != NULL){
+		print_timing_report(report_file);
+	}
+
+	/* print variants, every representation is prepared once */
+	for(int i = 0; i < number_of_variants; i++){
+		prepare_backend(variants[i].backend);
+		if((variants[i].filename != NULL) && (freopen(variants[i].filename, "w", stdout) == NULL)){
+			perror("freopen");
+			exit(1);
+		}
+		wcet = variants[i].wcet;
+		// 1 == Optimization is applied, 0 == optimization is not applied
+		optimization = variants[i].optimization > 0;
+		output_queue = variants[i].output_queue;
+		usedRegisters = backend_registers[variants[i].backend];
+		batch_cycles();
+
+		print_code();
+		fflush(stdout);
+	}
 
 	return 0;
 }
@@ -1,15 +1,32 @@
 #include <stdint.h>
 #include <avr/io.h>
-#include <util/delay.h>
+#include <avr/interrupt.h>
 
 #include "serialCom.h"
 
 #define FOSC 16000000UL
+//baud rate can be set with -DBAUD=... (CDEFS in Makefile)
+#ifndef BAUD
 #define BAUD 9600
-#define MYUBRR FOSC/16/BAUD-1
+#endif
+//rounded to the nearest divisor
+#define MYUBRR ((FOSC + 8UL * BAUD) / (16UL * BAUD) - 1)
+
+//size of transmit queue, must be a power of two
+#ifndef TX_BUFFER_SIZE
+#define TX_BUFFER_SIZE 64
+#endif
+#define TX_BUFFER_MASK (TX_BUFFER_SIZE - 1)
 
 uint8_t firstUse = 0;
 
+//transmit queue: putChar writes at txHead, USART_UDRE_vect reads at txTail
+volatile uint8_t txBuffer[TX_BUFFER_SIZE];
+volatile uint8_t txHead = 0;
+volatile uint8_t txTail = 0;
+//characters dropped because the queue was full while interrupts were disabled
+volatile uint16_t txDropped = 0;
+
 void
 USART_Init(unsigned int ubrr){
 	/* Set baud rate*/
@@ -21,12 +38,48 @@ USART_Init(unsigned int ubrr){
 	UCSR0C = (1<<USBS0)|(3<<UCSZ00);
 }
 
+//data register empty: send next character of queue, stop interrupt if queue is empty
+ISR(USART_UDRE_vect){
+	uint8_t tail = txTail;
+	if(tail == txHead){
+		UCSR0B &= ~(1 << UDRIE0);
+		return;
+	}
+	UDR0 = txBuffer[tail];
+	txTail = (tail + 1) & TX_BUFFER_MASK;
+}
+
 void
 USART_Transmit(unsigned char data){
-	/* Wait for empty transmit buffer */
-	while(!(UCSR0A & (1 << UDRE0)));
-	/* put data into buffer, send data */
-	UDR0 = data;
+	uint8_t head = txHead;
+	uint8_t next = (head + 1) & TX_BUFFER_MASK;
+	/* Wait for free space in queue, only possible if USART_UDRE_vect can run */
+	while(next == txTail){
+		if(!(SREG & (1 << SREG_I))){
+			txDropped++;
+			return;
+		}
+	}
+	/* put data into queue, send data in USART_UDRE_vect */
+	txBuffer[head] = data;
+	uint8_t temp = SREG;
+	cli();
+	txHead = next;
+	UCSR0B |= (1 << UDRIE0);
+	SREG = temp;
+}
+
+//free places in transmit queue, characters put while interrupts are disabled must fit
+uint8_t
+txFree(void){
+	return (txTail - txHead - 1) & TX_BUFFER_MASK;
+}
+
+//runs when main returns, before exit disables interrupts: sends rest of queue,
+//lowest priority: runs after all other destructors which may still print characters
+__attribute__((destructor(101))) void
+USART_Flush(void){
+	while((SREG & (1 << SREG_I)) && (txTail != txHead));
 }
 
 void
@@ -3,3 +3,4 @@ void putHex8(uint8_t hex);
 void putHex16(uint16_t hex);
 void putBin8(uint8_t data);
 void putDec16(uint16_t data);
+uint8_t txFree(void);